@@ -28,13 +28,25 @@ LIBS += -L$$PWD/third-party/uchardet \
 SOURCES += \
     src/ui/codeeditor.cpp \
     src/ui/editor.cpp \
+    src/ui/largefileviewer.cpp \
+    src/core/documentstats.cpp \
+    src/core/documenttext.cpp \
+    src/core/documentwriter.cpp \
     src/core/encdetector.cpp \
+    src/core/fileloader.cpp \
+    src/core/filesaver.cpp \
+    src/core/linescanner.cpp \
+    src/core/mappedfile.cpp \
+    src/core/updatescheduler.cpp \
     src/dialogs/findandreplace.cpp \
     src/dialogs/gotodialog.cpp \
     src/core/main.cpp \
     src/ui/edito.cpp \
     src/dialogs/preferencesdialog.cpp \
+    src/core/spellcache.cpp \
     src/core/spellchecker.cpp \
+    src/core/spellstate.cpp \
+    src/core/spelltokenizer.cpp \
     third-party/hunspell/affentry.cxx \
     third-party/hunspell/affixmgr.cxx \
     third-party/hunspell/csutil.cxx \
@@ -44,17 +56,30 @@ SOURCES += \
     third-party/hunspell/hunzip.cxx \
     third-party/hunspell/phonet.cxx \
     third-party/hunspell/replist.cxx \
+    third-party/hunspell/suggestindex.cxx \
     third-party/hunspell/suggestmgr.cxx
 
 HEADERS += \
     src/ui/codeeditor.h \
     src/ui/edito.h \
     src/ui/editor.h \
+    src/ui/largefileviewer.h \
+    src/core/documentstats.h \
+    src/core/documenttext.h \
+    src/core/documentwriter.h \
     src/core/encdetector.h \
+    src/core/fileloader.h \
+    src/core/filesaver.h \
+    src/core/linescanner.h \
+    src/core/mappedfile.h \
+    src/core/updatescheduler.h \
     src/dialogs/findandreplace.h \
     src/dialogs/gotodialog.h \
     src/dialogs/preferencesdialog.h \
+    src/core/spellcache.h \
     src/core/spellchecker.h \
+    src/core/spellstate.h \
+    src/core/spelltokenizer.h \
     third-party/hunspell/affentry.hxx \
     third-party/hunspell/affixmgr.hxx \
     third-party/hunspell/atypes.hxx \
@@ -71,6 +96,7 @@ HEADERS += \
     third-party/hunspell/langnum.hxx \
     third-party/hunspell/phonet.hxx \
     third-party/hunspell/replist.hxx \
+    third-party/hunspell/suggestindex.hxx \
     third-party/hunspell/suggestmgr.hxx \
     third-party/hunspell/utf_info.hxx \
     third-party/hunspell/w_char.hxx
@@ -0,0 +1,139 @@
+/*
+ * Edito - A modern, cross-platform text editor
+ * Copyright (C) 2025 Yovsky <Yovsky@proton.me>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "documentstats.h"
+#include <QTextBlock>
+#include <utility>
+
+DocumentStats::DocumentStats(QTextDocument *document)
+    : QObject(document)
+    , m_document(document)
+    , m_words(0)
+{
+    setObjectName(QStringLiteral("DocumentStats"));
+    recount();
+    connect(document, &QTextDocument::contentsChange, this, &DocumentStats::contentsChanged);
+}
+
+DocumentStats *DocumentStats::of(QTextDocument *document)
+{
+    if (!document)
+        return nullptr;
+    DocumentStats *stats = document->findChild<DocumentStats*>(QStringLiteral("DocumentStats"), Qt::FindDirectChildrenOnly);
+    return stats ? stats : new DocumentStats(document);
+}
+
+TextStats DocumentStats::stats() const
+{
+    TextStats res;
+    res.characters = m_document->characterCount() - 1; //Without the trailing paragraph separator.
+    res.words = m_words;
+    res.lines = m_document->blockCount();
+    return res;
+}
+
+TextStats DocumentStats::stats(int from, int to) const
+{
+    TextStats res;
+    if (to < from)
+        std::swap(from, to);
+    if (from == to)
+        return res;
+
+    QTextBlock first = m_document->findBlock(from);
+    QTextBlock last = m_document->findBlock(to);
+    res.characters = to - from;
+    res.lines = last.blockNumber() - first.blockNumber() + 1;
+
+    if (first == last)
+    {
+        res.words = countWords(QStringView(first.text()).sliced(from - first.position(), to - from));
+        return res;
+    }
+
+    //Partial first and last blocks are scanned, the ones in between come from the cache.
+    res.words = countWords(QStringView(first.text()).sliced(from - first.position()));
+    for (int b = first.blockNumber() + 1; b < last.blockNumber(); b++)
+        res.words += m_blockWords.at(b);
+    res.words += countWords(QStringView(last.text()).first(qMin(to - last.position(), last.length() - 1)));
+    return res;
+}
+
+qint64 DocumentStats::countWords(QStringView text)
+{
+    qint64 words = 0;
+    bool inWord = false;
+    for (QChar c : text)
+    {
+        if (c.isSpace())
+            inWord = false;
+        else if (!inWord)
+        {
+            inWord = true;
+            words++;
+        }
+    }
+    return words;
+}
+
+void DocumentStats::recount()
+{
+    m_blockWords.clear();
+    m_blockWords.reserve(m_document->blockCount());
+    m_words = 0;
+    for (QTextBlock block = m_document->begin(); block.isValid(); block = block.next())
+    {
+        int words = int(countWords(block.text()));
+        m_blockWords.append(words);
+        m_words += words;
+    }
+}
+
+void DocumentStats::contentsChanged(int position, int charsRemoved, int charsAdded)
+{
+    Q_UNUSED(charsRemoved);
+
+    //Blocks [first, last] now hold what used to be [first, last - added blocks].
+    const int added = m_document->blockCount() - m_blockWords.size();
+    const int first = m_document->findBlock(position).blockNumber();
+    const int last = m_document->findBlock(position + charsAdded).blockNumber();
+    const int oldLast = last - added;
+
+    if (first < 0 || last < 0 || oldLast < first || oldLast >= m_blockWords.size())
+    {
+        recount(); //Not a change we can follow (e.g. the whole document replaced).
+        return;
+    }
+
+    for (int b = first; b <= oldLast; b++)
+        m_words -= m_blockWords.at(b);
+
+    //Typing within a block keeps the count, the entries are overwritten in place; the list only moves for added or removed blocks.
+    if (added > 0)
+        m_blockWords.insert(oldLast + 1, added, 0);
+    else if (added < 0)
+        m_blockWords.remove(last + 1, -added);
+
+    QTextBlock block = m_document->findBlockByNumber(first);
+    for (int b = first; b <= last; b++, block = block.next())
+    {
+        int words = int(countWords(block.text()));
+        m_blockWords[b] = words;
+        m_words += words;
+    }
+}
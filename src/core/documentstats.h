@@ -0,0 +1,60 @@
+#ifndef DOCUMENTSTATS_H
+#define DOCUMENTSTATS_H
+
+/*
+ * Edito - A modern, cross-platform text editor
+ * Copyright (C) 2025 Yovsky <Yovsky@proton.me>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <QObject>
+#include <QList>
+#include <QStringView>
+#include <QTextDocument>
+
+struct TextStats
+{
+    qint64 characters = 0; //Line breaks included, as in toPlainText().
+    qint64 words = 0; //Runs of non-whitespace.
+    qint64 lines = 0;
+};
+
+// Character, word and line counts of a document, kept up to date from
+// contentsChange(). Every block's word count is cached, so an edit only
+// recounts the blocks it touched; line breaks are whitespace, so words
+// never span blocks. Lives as a child of its document, get it through of().
+class DocumentStats : public QObject
+{
+    Q_OBJECT
+
+public:
+    static DocumentStats *of(QTextDocument *document); //Created on first use.
+
+    TextStats stats() const;
+    TextStats stats(int from, int to) const; //Of a range, e.g. the selection; only its first and last blocks are scanned.
+
+    static qint64 countWords(QStringView text);
+
+private:
+    explicit DocumentStats(QTextDocument *document);
+    void recount();
+    void contentsChanged(int position, int charsRemoved, int charsAdded);
+
+    QTextDocument *m_document;
+    QList<int> m_blockWords; //Word count of every block, by block number.
+    qint64 m_words;
+};
+
+#endif // DOCUMENTSTATS_H
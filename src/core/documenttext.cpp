@@ -0,0 +1,55 @@
+/*
+ * Edito - A modern, cross-platform text editor
+ * Copyright (C) 2025 Yovsky <Yovsky@proton.me>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "documenttext.h"
+
+DocumentText::DocumentText(const QTextDocument *document)
+    : m_document(document)
+{
+}
+
+int DocumentText::length() const
+{
+    return m_document->characterCount() - 1; //characterCount() counts the trailing paragraph separator.
+}
+
+DocumentText::Iterator DocumentText::chunks() const
+{
+    return Iterator(m_document->begin());
+}
+
+DocumentText::Iterator::Iterator(const QTextBlock &first)
+    : m_block(first)
+{
+}
+
+bool DocumentText::Iterator::hasNext() const
+{
+    return m_block.isValid();
+}
+
+TextChunk DocumentText::Iterator::next()
+{
+    TextChunk chunk;
+    chunk.position = m_block.position();
+    chunk.text = m_block.text();
+    chunk.lineBreak = m_block.next().isValid();
+
+    m_block = m_block.next();
+    return chunk;
+}
@@ -0,0 +1,63 @@
+#ifndef DOCUMENTTEXT_H
+#define DOCUMENTTEXT_H
+
+/*
+ * Edito - A modern, cross-platform text editor
+ * Copyright (C) 2025 Yovsky <Yovsky@proton.me>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <QString>
+#include <QTextDocument>
+#include <QTextBlock>
+
+struct TextChunk
+{
+    QString text; //One line, without its line break.
+    int position; //Document position of the first character.
+    bool lineBreak; //A line break follows the text.
+};
+
+// Read access to a QTextDocument without toPlainText().
+// QTextDocument already stores its text as a piece table (an append-only
+// buffer indexed by a fragment tree), so inserts never depend on document
+// size; what it lacks is a way to read it back piecewise. This walks it one
+// block at a time, so readers hold at most one line instead of a full copy.
+class DocumentText
+{
+public:
+    class Iterator
+    {
+    public:
+        bool hasNext() const;
+        TextChunk next();
+
+    private:
+        friend class DocumentText;
+        explicit Iterator(const QTextBlock &first);
+
+        QTextBlock m_block;
+    };
+
+    explicit DocumentText(const QTextDocument *document);
+
+    int length() const; //Characters, line breaks included.
+    Iterator chunks() const;
+
+private:
+    const QTextDocument *m_document;
+};
+
+#endif // DOCUMENTTEXT_H
@@ -0,0 +1,160 @@
+/*
+ * Edito - A modern, cross-platform text editor
+ * Copyright (C) 2025 Yovsky <Yovsky@proton.me>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "documentwriter.h"
+#include "documenttext.h"
+
+DocumentWriter::DocumentWriter(const QTextDocument *document)
+    : m_document(document)
+    , m_encoding(QStringConverter::Encoding::Utf8)
+    , m_lineBreak(QStringLiteral("\n"))
+    , m_device(nullptr)
+    , m_used(0)
+    , m_writeBom(false)
+    , m_encodingError(false)
+{
+}
+
+DocumentWriter::DocumentWriter(const QString &snapshot)
+    : m_document(nullptr)
+    , m_snapshot(snapshot)
+    , m_encoding(QStringConverter::Encoding::Utf8)
+    , m_lineBreak(QStringLiteral("\n"))
+    , m_device(nullptr)
+    , m_used(0)
+    , m_writeBom(false)
+    , m_encodingError(false)
+{
+}
+
+void DocumentWriter::setEncoding(QStringConverter::Encoding enc)
+{
+    m_encoding = enc;
+}
+
+void DocumentWriter::setWriteBom(bool writeBom)
+{
+    m_writeBom = writeBom;
+}
+
+void DocumentWriter::setLineBreak(const QString &lineBreak)
+{
+    m_lineBreak = lineBreak;
+}
+
+QString DocumentWriter::lineBreakFor(const QString &lineEnding)
+{
+    if (lineEnding == "Windows (CR LF)")
+        return QStringLiteral("\r\n");
+    else if (lineEnding == "Macintosh (CR)")
+        return QStringLiteral("\r");
+    return QStringLiteral("\n");
+}
+
+QString DocumentWriter::snapshot(const QTextDocument *document)
+{
+    //One flat copy of the piece table, blocks still separated by U+2029.
+    QString text = document->toRawText();
+    text.truncate(DocumentText(document).length()); //Without the document's trailing separator.
+    return text;
+}
+
+bool DocumentWriter::hasEncodingError() const
+{
+    return m_encodingError;
+}
+
+bool DocumentWriter::write(QIODevice *device)
+{
+    m_device = device;
+    m_buffer.resize(BufferSize);
+    m_used = 0;
+    m_encodingError = false;
+
+    QStringEncoder encoder(m_encoding, m_writeBom ? QStringConverter::Flag::WriteBom : QStringConverter::Flag::Default); //The BOM is only written for Unicode encodings.
+    if (m_document)
+    {
+        DocumentText::Iterator chunks = DocumentText(m_document).chunks();
+        while (chunks.hasNext())
+        {
+            TextChunk chunk = chunks.next();
+            if (!writeText(encoder, chunk.text) || (chunk.lineBreak && !encode(encoder, m_lineBreak)))
+                return false;
+        }
+    }
+    else if (!writeText(encoder, m_snapshot))
+        return false;
+
+    return flush();
+}
+
+bool DocumentWriter::writeText(QStringEncoder &encoder, QStringView text)
+{
+    //Blocks never hold CR or LF, only paragraph (snapshots) and line (Shift+Enter) separators are left to convert.
+    qsizetype start = 0;
+    for (qsizetype i = 0; i < text.size(); i++)
+    {
+        const QChar c = text.at(i);
+        if (c == QChar::ParagraphSeparator || c == QChar::LineSeparator)
+        {
+            if (!encode(encoder, text.sliced(start, i - start)) || !encode(encoder, m_lineBreak))
+                return false;
+            start = i + 1;
+        }
+    }
+    return encode(encoder, text.sliced(start));
+}
+
+bool DocumentWriter::encode(QStringEncoder &encoder, QStringView text)
+{
+    while (!text.isEmpty())
+    {
+        //Largest piece whose worst-case output still fits in what is left of the buffer.
+        qsizetype piece = text.size();
+        while (piece > 0 && encoder.requiredSpace(piece) > BufferSize - m_used)
+            piece /= 2;
+        if (piece == 0)
+        {
+            if (!flush())
+                return false;
+            continue;
+        }
+        if (piece > 1 && piece < text.size() && text.at(piece - 1).isHighSurrogate())
+            piece--; //Keep surrogate pairs in one piece.
+
+        char *end = encoder.appendToBuffer(m_buffer.data() + m_used, text.first(piece));
+        m_used = end - m_buffer.constData();
+        text = text.sliced(piece);
+
+        if (encoder.hasError())
+        {
+            m_encodingError = true; //No point going on, the caller retries in another encoding.
+            return false;
+        }
+    }
+    return true;
+}
+
+bool DocumentWriter::flush()
+{
+    if (m_used == 0)
+        return true;
+    bool ok = m_device->write(m_buffer.constData(), m_used) == m_used;
+    m_used = 0;
+    return ok;
+}
@@ -0,0 +1,65 @@
+#ifndef DOCUMENTWRITER_H
+#define DOCUMENTWRITER_H
+
+/*
+ * Edito - A modern, cross-platform text editor
+ * Copyright (C) 2025 Yovsky <Yovsky@proton.me>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <QString>
+#include <QByteArray>
+#include <QIODevice>
+#include <QStringEncoder>
+#include <QTextDocument>
+
+// Writes a QTextDocument, or a snapshot of one, to a device one block at a time.
+// Line breaks are emitted as they are reached, and text is encoded straight
+// into a fixed-size buffer that goes to the device whenever it fills up,
+// so saving never holds more than one line and one buffer in memory.
+class DocumentWriter
+{
+public:
+    static constexpr qsizetype BufferSize = 256 * 1024; //Bytes encoded between two writes.
+
+    explicit DocumentWriter(const QTextDocument *document);
+    explicit DocumentWriter(const QString &snapshot); //Safe to write from any thread.
+    static QString snapshot(const QTextDocument *document); //GUI thread only, a single copy of the text.
+
+    void setEncoding(QStringConverter::Encoding enc);
+    void setLineBreak(const QString &lineBreak); //"\n" by default.
+    void setWriteBom(bool writeBom); //Start with a byte order mark, off by default.
+    static QString lineBreakFor(const QString &lineEnding); //Status bar name to characters, "\n" if unknown.
+
+    bool write(QIODevice *device); //False on an encoding or device error, the device may hold partial output.
+    bool hasEncodingError() const; //Some characters could not be represented in the encoding.
+
+private:
+    bool writeText(QStringEncoder &encoder, QStringView text);
+    bool encode(QStringEncoder &encoder, QStringView text);
+    bool flush();
+
+    const QTextDocument *m_document;
+    QString m_snapshot;
+    QStringConverter::Encoding m_encoding;
+    QString m_lineBreak;
+    QIODevice *m_device;
+    QByteArray m_buffer;
+    qsizetype m_used;
+    bool m_writeBom;
+    bool m_encodingError;
+};
+
+#endif // DOCUMENTWRITER_H
@@ -18,20 +18,43 @@
 
 #include "encdetector.h"
 #include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QHash>
+#include <QMap>
+#include <QMutex>
+#include <QMutexLocker>
 #include <QDebug>
 #include <uchardet.h>
 
-encdetector::encodingResult encdetector::detectEncoding(const QByteArray &data)
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define EDITO_HAVE_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace
 {
-    QMap<QString, QStringConverter::Encoding> encodings;
-    encodings["UTF-8"] = QStringConverter::Encoding::Utf8;
-    encodings["UTF-16LE"] = QStringConverter::Encoding::Utf16LE;
-    encodings["UTF-16BE"] = QStringConverter::Encoding::Utf16BE;
-    encodings["UTF-32LE"] = QStringConverter::Encoding::Utf32LE;
-    encodings["UTF-32BE"] = QStringConverter::Encoding::Utf32BE;
-    encodings["ISO-8859-1"] = QStringConverter::Encoding::Latin1;
-    encodings["System"] = QStringConverter::Encoding::System;
+constexpr qint64 WindowSize = 4 * 1024; //Bytes per sample window.
+constexpr int MaxWindows = 64; //At most 256 KB ever reach uchardet.
+constexpr int Stages[] = { 4, 16, MaxWindows }; //Windows fed before each confidence check.
+constexpr float ConfidentEnough = 0.9f;
+constexpr int CacheLimit = 256;
+
+QMutex cacheMutex;
+QHash<QString, encdetector::encodingResult> cache;
+
+encdetector::encodingResult utf8Result(bool hasBOM)
+{
+    encdetector::encodingResult res;
+    res.encoding = "UTF-8";
+    res.converterEnc = QStringConverter::Encoding::Utf8;
+    res.hasBOM = hasBOM;
+    return res;
+}
+}
 
+encdetector::encodingResult encdetector::detectEncoding(const QByteArray &data)
+{
     encdetector::encodingResult res;
     res.hasBOM = false;
 
@@ -40,55 +63,230 @@ encdetector::encodingResult encdetector::detectEncoding(const QByteArray &data)
     qDebug() << data.left(8).toHex(' ');
 
     //Try detecting by BOM.
-    if(data.startsWith(QByteArray::fromRawData("\xEF\xBB\xBF", 3)))
+    if (detectByBOM(data, res))
+        return res;
+
+    //Most files are ASCII or UTF-8, validating is far cheaper than running the detector.
+    if (isValidUtf8(data))
+    {
+        qDebug() << "validated UTF-8";
+        return utf8Result(false);
+    }
+
+    //Try detecting by uchardet, on evenly spaced windows only.
+    QList<QByteArrayView> windows;
+    for (const QPair<qint64, qint64> &w : sampleWindows(data.size(), MaxWindows))
+        windows.append(QByteArrayView(data).sliced(w.first, w.second));
+
+    return detectWithUchardet(windows);
+}
+
+encdetector::encodingResult encdetector::detectEncoding(const QString &filePath, const QByteArray &data)
+{
+    QString key = cacheKey(filePath);
+    encodingResult res;
+    if (cachedResult(key, res))
+        return res;
+
+    res = detectEncoding(data);
+    storeResult(key, res);
+    return res;
+}
+
+encdetector::encodingResult encdetector::detectFile(const QString &filePath)
+{
+    QString key = cacheKey(filePath);
+    encodingResult res;
+    if (cachedResult(key, res))
+        return res;
+
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        res.encoding = "Unknown";
+        res.converterEnc = QStringConverter::Encoding::Utf8;
+        res.hasBOM = false;
+        return res;
+    }
+
+    //Same windows detectEncoding() would look at, read straight from disk.
+    QList<QByteArray> buffers;
+    QList<QByteArrayView> windows;
+    for (const QPair<qint64, qint64> &w : sampleWindows(file.size(), MaxWindows))
+    {
+        file.seek(w.first);
+        buffers.append(file.read(w.second));
+        windows.append(buffers.last());
+    }
+    file.close();
+
+    res.hasBOM = false;
+    bool partial = windows.size() > 1; //A single window is the whole file.
+    if (windows.isEmpty() || !detectByBOM(windows.first(), res))
+    {
+        bool valid = true;
+        for (const QByteArrayView &w : windows)
+            valid = valid && isValidUtf8(w, partial);
+        res = valid ? utf8Result(false) : detectWithUchardet(windows);
+    }
+
+    storeResult(key, res);
+    return res;
+}
+
+QString encdetector::detectFileEncoding(const QString &filePath)
+{
+    if (!QFile::exists(filePath))
+        return "Unknown";
+
+    return detectFile(filePath).encoding;
+}
+
+bool encdetector::detectByBOM(QByteArrayView data, encodingResult &res)
+{
+    if(data.startsWith(QByteArrayView("\xEF\xBB\xBF", 3)))
     {
         qDebug() << "detected UTF-8";
         res.encoding = "UTF-8";
         res.converterEnc = QStringConverter::Encoding::Utf8;
         res.hasBOM = true;
-        return res;
+        return true;
     }
-    else if(data.startsWith(QByteArray::fromRawData("\xFF\xFE\x00\x00", 4)))
+    else if(data.startsWith(QByteArrayView("\xFF\xFE\x00\x00", 4)))
     {
         qDebug() << "detected UTF-32LE";
         res.encoding = "UTF-32LE";
         res.converterEnc = QStringConverter::Encoding::Utf32LE;
         res.hasBOM = true;
-        return res;
+        return true;
     }
-    else if(data.startsWith(QByteArray::fromRawData("\xFF\xFE", 2)))
+    else if(data.startsWith(QByteArrayView("\xFF\xFE", 2)))
     {
         qDebug() << "detected UTF-16LE";
         res.encoding = "UTF-16LE";
         res.converterEnc = QStringConverter::Encoding::Utf16LE;
         res.hasBOM = true;
-        return res;
+        return true;
     }
-    else if(data.startsWith(QByteArray::fromRawData("\xFE\xFF", 2)))
+    else if(data.startsWith(QByteArrayView("\xFE\xFF", 2)))
     {
         qDebug() << "detected UTF-16BE";
         res.encoding = "UTF-16BE";
         res.converterEnc = QStringConverter::Encoding::Utf16BE;
         res.hasBOM = true;
-        return res;
+        return true;
     }
-    else if(data.startsWith(QByteArray::fromRawData("\x00\x00\xFE\xFF", 4)))
+    else if(data.startsWith(QByteArrayView("\x00\x00\xFE\xFF", 4)))
     {
         qDebug() << "detected UTF-32BE";
         res.encoding = "UTF-32BE";
         res.converterEnc = QStringConverter::Encoding::Utf32BE;
         res.hasBOM = true;
-        return res;
+        return true;
     }
+    return false;
+}
+
+bool encdetector::isValidUtf8(QByteArrayView data, bool partial)
+{
+    const uchar *p = reinterpret_cast<const uchar*>(data.data());
+    const qsizetype n = data.size();
+    qsizetype i = 0;
+
+    //A window may start in the middle of a sequence.
+    if (partial)
+    {
+        while (i < n && i < 3 && (p[i] & 0xC0) == 0x80)
+            i++;
+    }
+
+    while (i < n)
+    {
+#if defined(EDITO_HAVE_SSE2)
+        //Skip ASCII 16 bytes at a time, NUL bytes mean UTF-16/32 without BOM or binary data.
+        const __m128i zero = _mm_setzero_si128();
+        while (i + 16 <= n)
+        {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+            if (_mm_movemask_epi8(_mm_cmpeq_epi8(v, zero)))
+                return false;
+            if (_mm_movemask_epi8(v))
+                break; //Non-ASCII byte in this block, validate it below.
+            i += 16;
+        }
+        if (i >= n)
+            break;
+#endif
+        uchar c = p[i];
+        if (c < 0x80)
+        {
+            if (c == 0)
+                return false;
+            i++;
+            continue;
+        }
+
+        int len;
+        quint32 min;
+        if ((c & 0xE0) == 0xC0) { len = 2; min = 0x80; }
+        else if ((c & 0xF0) == 0xE0) { len = 3; min = 0x800; }
+        else if ((c & 0xF8) == 0xF0) { len = 4; min = 0x10000; }
+        else return false;
+
+        quint32 cp = c & (0x7F >> len);
+        for (int k = 1; k < len; k++)
+        {
+            if (i + k >= n)
+                return partial; //Sequence cut by the end of the window.
+            uchar cc = p[i + k];
+            if ((cc & 0xC0) != 0x80)
+                return false;
+            cp = (cp << 6) | (cc & 0x3F);
+        }
+        if (cp < min || cp > 0x10FFFF || (cp >= 0xD800 && cp <= 0xDFFF))
+            return false; //Overlong, out of range or surrogate.
+        i += len;
+    }
+    return true;
+}
+
+encdetector::encodingResult encdetector::detectWithUchardet(const QList<QByteArrayView> &windows)
+{
+    QMap<QString, QStringConverter::Encoding> encodings;
+    encodings["UTF-8"] = QStringConverter::Encoding::Utf8;
+    encodings["UTF-16LE"] = QStringConverter::Encoding::Utf16LE;
+    encodings["UTF-16BE"] = QStringConverter::Encoding::Utf16BE;
+    encodings["UTF-32LE"] = QStringConverter::Encoding::Utf32LE;
+    encodings["UTF-32BE"] = QStringConverter::Encoding::Utf32BE;
+    encodings["ISO-8859-1"] = QStringConverter::Encoding::Latin1;
+    encodings["System"] = QStringConverter::Encoding::System;
+
+    encdetector::encodingResult res;
+    res.hasBOM = false;
 
-    //Try detecting by uchardet.
     uchardet_t detect = uchardet_new();
 
-    uchardet_handle_data(detect, data.constData(), data.size());
-    uchardet_data_end(detect);
+    //Feed a growing subset of the windows, stop as soon as the detector is sure.
+    QString enc;
+    for (int stage : Stages)
+    {
+        int count = qMin<int>(stage, windows.size());
+        uchardet_reset(detect);
+        for (int k = 0; k < count; k++)
+        {
+            const QByteArrayView &w = windows.at(count > 1 ? k * (windows.size() - 1) / (count - 1) : 0);
+            uchardet_handle_data(detect, w.data(), w.size());
+        }
+        uchardet_data_end(detect);
+
+        float confidence = uchardet_get_n_candidates(detect) > 0 ? uchardet_get_confidence(detect, 0) : 0.0f;
+        enc = uchardet_get_encoding(detect, 0);
+        qDebug() << enc << confidence << "from" << count << "windows";
+
+        if (confidence >= ConfidentEnough || count == windows.size())
+            break;
+    }
 
-    QString enc = uchardet_get_encoding(detect, data.size());
-    qDebug() << enc;
     if (encodings.contains(enc))
     {
         res.encoding = enc;
@@ -106,18 +304,42 @@ encdetector::encodingResult encdetector::detectEncoding(const QByteArray &data)
     return res;
 }
 
-QString encdetector::detectFileEncoding(const QString &filePath)
+QList<QPair<qint64, qint64>> encdetector::sampleWindows(qint64 size, int count)
 {
-    QFile file(filePath);
+    QList<QPair<qint64, qint64>> windows;
+    if (size <= WindowSize * count)
+    {
+        windows.append({0, size}); //Small enough to look at whole.
+        return windows;
+    }
 
-    if (!file.open(QIODevice::ReadOnly))
-        return "Unknown";
+    for (int k = 0; k < count; k++)
+        windows.append({k * (size - WindowSize) / (count - 1), WindowSize});
+    return windows;
+}
 
-    QByteArray data = file.read(1024);
-    file.close();
+QString encdetector::cacheKey(const QString &filePath)
+{
+    QFileInfo info(filePath);
+    return info.absoluteFilePath() + '|' + QString::number(info.size()) + '|' + QString::number(info.lastModified().toMSecsSinceEpoch());
+}
+
+bool encdetector::cachedResult(const QString &key, encodingResult &res)
+{
+    QMutexLocker locker(&cacheMutex);
+    auto it = cache.constFind(key);
+    if (it == cache.constEnd())
+        return false;
+    res = it.value();
+    return true;
+}
 
-    encodingResult result = detectEncoding(data);
-    return result.encoding;
+void encdetector::storeResult(const QString &key, const encodingResult &res)
+{
+    QMutexLocker locker(&cacheMutex);
+    if (cache.size() >= CacheLimit)
+        cache.clear(); //Simple bound, the cache only saves re-detection on reopen.
+    cache.insert(key, res);
 }
 
 QList<QStringConverter::Encoding> encdetector::supportedEncodings()
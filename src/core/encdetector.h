@@ -22,6 +22,8 @@
 #include <QString>
 #include <QStringConverter>
 #include <QByteArray>
+#include <QByteArrayView>
+#include <QList>
 
 class encdetector
 {
@@ -34,8 +36,21 @@ public:
     };
 
     static encodingResult detectEncoding(const QByteArray &data);
+    static encodingResult detectEncoding(const QString &filePath, const QByteArray &data); //Cached by path, size and mtime.
+    static encodingResult detectFile(const QString &filePath); //Reads only a sample of the file, cached.
     static QString detectFileEncoding(const QString &filePath);
     static QList<QStringConverter::Encoding> supportedEncodings();
+
+    //partial: data is a window cut out of a larger file, sequences cut at either end are accepted.
+    static bool isValidUtf8(QByteArrayView data, bool partial = false);
+
+private:
+    static bool detectByBOM(QByteArrayView data, encodingResult &res);
+    static encodingResult detectWithUchardet(const QList<QByteArrayView> &windows);
+    static QList<QPair<qint64, qint64>> sampleWindows(qint64 size, int count);
+    static QString cacheKey(const QString &filePath);
+    static bool cachedResult(const QString &key, encodingResult &res);
+    static void storeResult(const QString &key, const encodingResult &res);
 };
 
 #endif // ENCDETECTOR_H
@@ -0,0 +1,196 @@
+/*
+ * Edito - A modern, cross-platform text editor
+ * Copyright (C) 2025 Yovsky <Yovsky@proton.me>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "fileloader.h"
+#include "encdetector.h"
+#include "linescanner.h"
+#include <QFile>
+#include <QStringDecoder>
+#include <QPlainTextDocumentLayout>
+#include <QDebug>
+
+namespace
+{
+constexpr qint64 ReadChunk = 4 * 1024 * 1024; //Bytes read between progress/cancel checks.
+constexpr qsizetype DecodeChunk = 4 * 1024 * 1024; //Bytes decoded between progress/cancel checks.
+constexpr qint64 ScanChunk = 64 * 1024 * 1024; //Bytes scanned for line endings between progress/cancel checks.
+
+//Progress ranges of each stage, in percent.
+constexpr int ReadEnd = 40;
+constexpr int ScanEnd = 45;
+constexpr int DetectEnd = 50;
+constexpr int DecodeEnd = 80;
+}
+
+FileLoader::FileLoader(const QString &filePath, QThread *targetThread, QObject *parent)
+    : QObject(parent)
+    , m_filePath(filePath)
+    , m_targetThread(targetThread)
+    , m_canceled(false)
+    , m_lastProgress(-1)
+{
+    qRegisterMetaType<FileLoadResult>();
+}
+
+void FileLoader::cancel()
+{
+    m_canceled.store(true, std::memory_order_relaxed);
+}
+
+bool FileLoader::isCanceled() const
+{
+    return m_canceled.load(std::memory_order_relaxed);
+}
+
+void FileLoader::reportProgress(int percent, const QString &stage)
+{
+    if (percent == m_lastProgress) return; //Don't flood the GUI thread with identical updates.
+    m_lastProgress = percent;
+    emit progress(percent, stage);
+}
+
+void FileLoader::run()
+{
+    QByteArray data;
+    if (!readFile(data))
+    {
+        if (isCanceled()) emit canceled();
+        emit finished();
+        return;
+    }
+
+    //Line endings.
+    LineScanner scanner(data.constData(), data.size(), 0); //Only the counts are needed, the document indexes its own lines.
+    while (scanner.position() < data.size())
+    {
+        if (isCanceled())
+        {
+            emit canceled();
+            emit finished();
+            return;
+        }
+        scanner.scan(scanner.position() + ScanChunk);
+        reportProgress(ReadEnd + int(scanner.position() * (ScanEnd - ReadEnd) / data.size()), tr("Scanning"));
+    }
+    QString lineEnding = scanner.lineEnding();
+
+    //Encoding.
+    reportProgress(ScanEnd, tr("Detecting encoding"));
+    encdetector::encodingResult enc = encdetector::detectEncoding(m_filePath, data);
+
+    //Decoding, with the same UTF-8 then Latin-1 fallback chain as before.
+    reportProgress(DetectEnd, tr("Decoding"));
+    QString content;
+    bool usedFallback = false;
+    if (!decode(data, enc.converterEnc, content))
+    {
+        if (isCanceled())
+        {
+            emit canceled();
+            emit finished();
+            return;
+        }
+        usedFallback = true;
+        if (!decode(data, QStringConverter::Encoding::Utf8, content) && !isCanceled())
+            decode(data, QStringConverter::Encoding::Latin1, content);
+    }
+    data.clear(); //The raw bytes are no longer needed, release them before building the document.
+
+    if (isCanceled())
+    {
+        emit canceled();
+        emit finished();
+        return;
+    }
+
+    //Document. The layout is created here too so the per-block bookkeeping it does on setPlainText stays off the GUI thread.
+    reportProgress(DecodeEnd, tr("Building document"));
+    QTextDocument *document = new QTextDocument;
+    document->setDocumentLayout(new QPlainTextDocumentLayout(document));
+    document->setUndoRedoEnabled(false);
+    document->setPlainText(content);
+    document->setUndoRedoEnabled(true);
+    content.clear();
+
+    if (isCanceled())
+    {
+        delete document;
+        emit canceled();
+        emit finished();
+        return;
+    }
+
+    document->moveToThread(m_targetThread); //Hand the document over to the thread that will own it.
+
+    FileLoadResult result;
+    result.filePath = m_filePath;
+    result.document = document;
+    result.encoding = enc.encoding;
+    result.hasBOM = enc.hasBOM;
+    result.lineEnding = lineEnding;
+    result.usedFallback = usedFallback;
+
+    reportProgress(100, tr("Done"));
+    emit loaded(result);
+    emit finished();
+}
+
+bool FileLoader::readFile(QByteArray &data)
+{
+    QFile file(m_filePath);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        emit failed(tr("Failed to open file ") + m_filePath);
+        return false;
+    }
+
+    const qint64 size = file.size();
+    data = QByteArray(size, Qt::Uninitialized);
+
+    qint64 total = 0;
+    while (total < size)
+    {
+        if (isCanceled()) return false;
+
+        qint64 read = file.read(data.data() + total, qMin(ReadChunk, size - total));
+        if (read <= 0) break; //Short read (file shrank while reading), keep what we got.
+        total += read;
+        reportProgress(int(total * ReadEnd / qMax<qint64>(size, 1)), tr("Reading"));
+    }
+    data.truncate(total);
+
+    qDebug() << "opened size" + QString::number(data.size());
+    return true;
+}
+
+bool FileLoader::decode(const QByteArray &data, QStringConverter::Encoding enc, QString &content)
+{
+    QStringDecoder decoder(enc);
+    content.clear();
+
+    const qsizetype size = data.size();
+    for (qsizetype pos = 0; pos < size; pos += DecodeChunk)
+    {
+        if (isCanceled()) return false;
+
+        const qsizetype len = qMin(DecodeChunk, size - pos);
+        content += decoder.decode(QByteArrayView(data).sliced(pos, len));
+        reportProgress(DetectEnd + int((pos + len) * (DecodeEnd - DetectEnd) / size), tr("Decoding"));
+    }
+    return !decoder.hasError();
+}
@@ -0,0 +1,76 @@
+#ifndef FILELOADER_H
+#define FILELOADER_H
+
+/*
+ * Edito - A modern, cross-platform text editor
+ * Copyright (C) 2025 Yovsky <Yovsky@proton.me>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <QObject>
+#include <QString>
+#include <QByteArray>
+#include <QStringConverter>
+#include <QTextDocument>
+#include <QThread>
+#include <atomic>
+
+struct FileLoadResult
+{
+    QString filePath;
+    QTextDocument *document = nullptr; //Owned by the receiver once delivered.
+    QString encoding;
+    QString lineEnding;
+    bool hasBOM = false;
+    bool usedFallback = false; //Detected encoding failed and a fallback decoder was used.
+};
+
+Q_DECLARE_METATYPE(FileLoadResult)
+
+// Reads, detects, decodes and lays out a file on a worker thread.
+// Move the loader to a QThread and start it through run(); the finished
+// document is moved to the target thread before loaded() is emitted.
+class FileLoader : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit FileLoader(const QString &filePath, QThread *targetThread, QObject *parent = nullptr);
+    void cancel(); //Safe to call from any thread.
+    bool isCanceled() const;
+
+public slots:
+    void run();
+
+private:
+    bool readFile(QByteArray &data);
+    bool decode(const QByteArray &data, QStringConverter::Encoding enc, QString &content);
+
+    QString m_filePath;
+    QThread *m_targetThread;
+    std::atomic<bool> m_canceled;
+    int m_lastProgress;
+
+    void reportProgress(int percent, const QString &stage);
+
+signals:
+    void progress(int percent, const QString &stage);
+    void loaded(const FileLoadResult &result);
+    void failed(const QString &error);
+    void canceled();
+    void finished(); //Always emitted last, whatever the outcome.
+};
+
+#endif // FILELOADER_H
@@ -0,0 +1,80 @@
+/*
+ * Edito - A modern, cross-platform text editor
+ * Copyright (C) 2025 Yovsky <Yovsky@proton.me>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "filesaver.h"
+#include "documentwriter.h"
+#include <QSaveFile>
+
+FileSaver::FileSaver(const QString &filePath, const QString &snapshot, QStringConverter::Encoding enc, const QString &lineBreak, bool writeBom, QObject *parent)
+    : QObject(parent)
+    , m_filePath(filePath)
+    , m_snapshot(snapshot)
+    , m_encoding(enc)
+    , m_lineBreak(lineBreak)
+    , m_writeBom(writeBom)
+{
+}
+
+QString FileSaver::filePath() const
+{
+    return m_filePath;
+}
+
+void FileSaver::run()
+{
+    DocumentWriter writer(m_snapshot);
+    writer.setLineBreak(m_lineBreak);
+    writer.setWriteBom(m_writeBom);
+
+    //Chosen encoding first, then UTF-8 if some characters can't be represented.
+    QList<QStringConverter::Encoding> encodings = { m_encoding };
+    if (m_encoding != QStringConverter::Encoding::Utf8)
+        encodings.append(QStringConverter::Encoding::Utf8);
+
+    for (int i = 0; i < encodings.size(); i++)
+    {
+        QSaveFile file(m_filePath);
+        if (!file.open(QIODevice::WriteOnly))
+        {
+            emit failed(file.errorString());
+            emit finished();
+            return;
+        }
+
+        writer.setEncoding(encodings.at(i));
+        if (!writer.write(&file))
+        {
+            if (writer.hasEncodingError() && i + 1 < encodings.size())
+                continue; //Uncommitted, the temporary file is dropped.
+            emit failed(writer.hasEncodingError() ? tr("The text can't be encoded") : file.errorString());
+            emit finished();
+            return;
+        }
+
+        if (!file.commit()) //Flushes, syncs to disk and renames over the target.
+        {
+            emit failed(file.errorString());
+            emit finished();
+            return;
+        }
+
+        emit saved(i > 0);
+        emit finished();
+        return;
+    }
+}
@@ -0,0 +1,54 @@
+#ifndef FILESAVER_H
+#define FILESAVER_H
+
+/*
+ * Edito - A modern, cross-platform text editor
+ * Copyright (C) 2025 Yovsky <Yovsky@proton.me>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <QObject>
+#include <QString>
+#include <QStringConverter>
+
+// Encodes and writes a document snapshot, normally on a worker thread.
+// The file goes through QSaveFile: written to a temporary file, synced
+// and renamed over the target, so a failed save never leaves it half written.
+// Move the saver to a QThread and start it through run(), or call run() directly to save in place.
+class FileSaver : public QObject
+{
+    Q_OBJECT
+
+public:
+    FileSaver(const QString &filePath, const QString &snapshot, QStringConverter::Encoding enc, const QString &lineBreak, bool writeBom, QObject *parent = nullptr);
+    QString filePath() const;
+
+public slots:
+    void run();
+
+private:
+    QString m_filePath;
+    QString m_snapshot; //From DocumentWriter::snapshot().
+    QStringConverter::Encoding m_encoding;
+    QString m_lineBreak;
+    bool m_writeBom; //The file was opened with a BOM, it keeps it.
+
+signals:
+    void saved(bool usedFallback); //usedFallback: written as UTF-8, the chosen encoding could not hold the text.
+    void failed(const QString &error);
+    void finished(); //Always emitted last, whatever the outcome.
+};
+
+#endif // FILESAVER_H
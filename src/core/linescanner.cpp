@@ -0,0 +1,264 @@
+/*
+ * Edito - A modern, cross-platform text editor
+ * Copyright (C) 2025 Yovsky <Yovsky@proton.me>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "linescanner.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define EDITO_HAVE_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined(EDITO_HAVE_SSE2) && defined(__GNUC__)
+#define EDITO_HAVE_AVX2 //Compiled through a target attribute, picked at run time.
+#include <immintrin.h>
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace
+{
+enum Kernel { Scalar, Sse2, Avx2 };
+
+Kernel detectKernel()
+{
+#if defined(EDITO_HAVE_AVX2)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return Avx2;
+#endif
+#if defined(EDITO_HAVE_SSE2)
+    return Sse2;
+#else
+    return Scalar;
+#endif
+}
+
+Kernel activeKernel()
+{
+    static const Kernel kernel = detectKernel();
+    return kernel;
+}
+
+inline int lowestBit(quint32 mask)
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return int(index);
+#else
+    return __builtin_ctz(mask);
+#endif
+}
+}
+
+LineScanner::LineScanner(const char *data, qint64 size, qint64 stride)
+    : m_data(data)
+    , m_size(size)
+    , m_stride(stride)
+    , m_pos(0)
+    , m_lines(1)
+    , m_crlf(0)
+    , m_cr(0)
+    , m_lf(0)
+{
+    if (m_stride > 0)
+        m_starts.append(0); //Line 0.
+}
+
+void LineScanner::scan(qint64 to)
+{
+    to = qMin(to, m_size);
+    if (to <= m_pos)
+        return;
+
+    switch (activeKernel())
+    {
+    case Avx2:
+        m_pos = scanAvx2(m_pos, to);
+        break;
+    case Sse2:
+        m_pos = scanSse2(m_pos, to);
+        break;
+    default:
+        break;
+    }
+    m_pos = scanScalar(m_pos, to); //Tail shorter than a vector.
+}
+
+void LineScanner::scanAll()
+{
+    scan(m_size);
+}
+
+qint64 LineScanner::position() const
+{
+    return m_pos;
+}
+
+qint64 LineScanner::lineCount() const
+{
+    return m_lines;
+}
+
+qint64 LineScanner::crlfCount() const
+{
+    return m_crlf;
+}
+
+qint64 LineScanner::crCount() const
+{
+    return m_cr;
+}
+
+qint64 LineScanner::lfCount() const
+{
+    return m_lf;
+}
+
+QString LineScanner::lineEnding() const
+{
+    return lineEnding(m_crlf, m_cr, m_lf);
+}
+
+const QList<qint64> &LineScanner::lineStarts() const
+{
+    return m_starts;
+}
+
+QList<qint64> LineScanner::takeLineStarts()
+{
+    QList<qint64> starts;
+    starts.swap(m_starts);
+    return starts;
+}
+
+QString LineScanner::lineEnding(qint64 crlf, qint64 cr, qint64 lf)
+{
+    if (crlf > cr && crlf > lf)
+        return "Windows (CR LF)";
+    else if (cr > crlf && cr > lf)
+        return "Macintosh (CR)";
+    else if (lf > crlf && lf > cr)
+        return "Unix (LF)";
+    else if (cr == 0 && lf == 0 && crlf == 0)
+        return "Unknown";
+    return "Mixed";
+}
+
+const char *LineScanner::kernelName()
+{
+    switch (activeKernel())
+    {
+    case Avx2:
+        return "AVX2";
+    case Sse2:
+        return "SSE2";
+    default:
+        return "scalar";
+    }
+}
+
+inline void LineScanner::recordLine(qint64 start)
+{
+    if (m_stride > 0 && m_lines % m_stride == 0)
+        m_starts.append(start);
+    m_lines++;
+}
+
+inline void LineScanner::hit(qint64 pos)
+{
+    if (m_data[pos] == '\n')
+    {
+        if (pos > 0 && m_data[pos - 1] == '\r')
+            return; //Second half of a CR LF, counted with the CR.
+        m_lf++;
+        recordLine(pos + 1);
+    }
+    else if (pos + 1 < m_size && m_data[pos + 1] == '\n') //Looks past the scan limit on purpose, pairs split across steps stay whole.
+    {
+        m_crlf++;
+        recordLine(pos + 2);
+    }
+    else
+    {
+        m_cr++;
+        recordLine(pos + 1);
+    }
+}
+
+qint64 LineScanner::scanScalar(qint64 from, qint64 to)
+{
+    for (qint64 i = from; i < to; i++)
+    {
+        if (m_data[i] == '\n' || m_data[i] == '\r')
+            hit(i);
+    }
+    return to;
+}
+
+qint64 LineScanner::scanSse2(qint64 from, qint64 to)
+{
+#if defined(EDITO_HAVE_SSE2)
+    const __m128i lf = _mm_set1_epi8('\n');
+    const __m128i cr = _mm_set1_epi8('\r');
+
+    qint64 i = from;
+    for (; i + 16 <= to; i += 16)
+    {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(m_data + i));
+        quint32 mask = quint32(_mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(v, lf), _mm_cmpeq_epi8(v, cr))));
+        while (mask)
+        {
+            hit(i + lowestBit(mask));
+            mask &= mask - 1;
+        }
+    }
+    return i;
+#else
+    Q_UNUSED(to);
+    return from;
+#endif
+}
+
+#if defined(EDITO_HAVE_AVX2)
+__attribute__((target("avx2")))
+#endif
+qint64 LineScanner::scanAvx2(qint64 from, qint64 to)
+{
+#if defined(EDITO_HAVE_AVX2)
+    const __m256i lf = _mm256_set1_epi8('\n');
+    const __m256i cr = _mm256_set1_epi8('\r');
+
+    qint64 i = from;
+    for (; i + 32 <= to; i += 32)
+    {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(m_data + i));
+        quint32 mask = quint32(_mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(v, lf), _mm256_cmpeq_epi8(v, cr))));
+        while (mask)
+        {
+            hit(i + lowestBit(mask));
+            mask &= mask - 1;
+        }
+    }
+    return scanSse2(i, to);
+#else
+    return scanSse2(from, to);
+#endif
+}
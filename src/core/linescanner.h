@@ -0,0 +1,72 @@
+#ifndef LINESCANNER_H
+#define LINESCANNER_H
+
+/*
+ * Edito - A modern, cross-platform text editor
+ * Copyright (C) 2025 Yovsky <Yovsky@proton.me>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <QtGlobal>
+#include <QList>
+#include <QString>
+
+// Single pass over raw bytes that classifies line endings (CR LF, CR, LF)
+// and records line start offsets. Bytes are tested 32 (AVX2) or 16 (SSE2)
+// at a time, only positions holding CR or LF are looked at individually.
+// Line breaks follow QTextDocument: CR LF, lone CR and lone LF each end a line.
+// scan() can be called repeatedly with increasing limits, so callers can
+// report progress or stop between steps.
+class LineScanner
+{
+public:
+    // stride: record the start of every stride-th line (1 = all lines, 0 = none).
+    LineScanner(const char *data, qint64 size, qint64 stride = 1);
+
+    void scan(qint64 to); //Continue up to byte offset to.
+    void scanAll();
+    qint64 position() const;
+
+    qint64 lineCount() const; //Lines started so far, the first line included.
+    qint64 crlfCount() const;
+    qint64 crCount() const;
+    qint64 lfCount() const;
+    QString lineEnding() const; //Dominant ending, as shown in the status bar.
+
+    const QList<qint64> &lineStarts() const; //Offsets of lines 0, stride, 2*stride...
+    QList<qint64> takeLineStarts(); //Hands over the offsets found so far, scanning can go on.
+
+    static QString lineEnding(qint64 crlf, qint64 cr, qint64 lf);
+    static const char *kernelName(); //"AVX2", "SSE2" or "scalar", for diagnostics.
+
+private:
+    void hit(qint64 pos);
+    void recordLine(qint64 start);
+    qint64 scanScalar(qint64 from, qint64 to);
+    qint64 scanSse2(qint64 from, qint64 to);
+    qint64 scanAvx2(qint64 from, qint64 to);
+
+    const char *m_data;
+    qint64 m_size;
+    qint64 m_stride;
+    qint64 m_pos;
+    qint64 m_lines;
+    qint64 m_crlf;
+    qint64 m_cr;
+    qint64 m_lf;
+    QList<qint64> m_starts;
+};
+
+#endif // LINESCANNER_H
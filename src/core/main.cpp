@@ -35,6 +35,10 @@ int main(int argc, char *argv[])
         }
     }
     Edito w;
-    w.show();
+    QStringList targets = a.arguments().mid(1); //Files given on the command line, "file:line" included.
+    if (targets.isEmpty())
+        w.show();
+    else
+        w.openFiles(targets);
     return a.exec();
 }
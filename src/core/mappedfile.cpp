@@ -0,0 +1,246 @@
+/*
+ * Edito - A modern, cross-platform text editor
+ * Copyright (C) 2025 Yovsky <Yovsky@proton.me>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "mappedfile.h"
+#include "linescanner.h"
+#include <QStringDecoder>
+#include <QMutexLocker>
+#include <cstring>
+#include <algorithm>
+
+namespace
+{
+constexpr qint64 ReportBytes = 64 * 1024 * 1024; //Index progress is published every 64 MB scanned.
+}
+
+MappedFile::MappedFile(const QString &filePath, QObject *parent)
+    : QObject(parent)
+    , m_file(filePath)
+    , m_data(nullptr)
+    , m_size(0)
+    , m_encoding(QStringConverter::Encoding::Utf8)
+    , m_lineCount(0)
+    , m_indexComplete(false)
+    , m_stop(false)
+    , m_indexer(nullptr)
+{
+}
+
+MappedFile::~MappedFile()
+{
+    m_stop.store(true);
+    if (m_indexer)
+    {
+        m_indexer->wait(); //The indexer reads the mapping, it must be gone before unmapping.
+        delete m_indexer;
+    }
+    if (m_data)
+        m_file.unmap(const_cast<uchar*>(m_data));
+}
+
+bool MappedFile::open()
+{
+    if (!m_file.open(QIODevice::ReadOnly))
+        return false;
+
+    m_size = m_file.size();
+    if (m_size > 0)
+    {
+        m_data = m_file.map(0, m_size);
+        if (!m_data)
+            return false;
+    }
+
+    m_indexer = QThread::create([this]() { buildIndex(); });
+    m_indexer->start(QThread::LowPriority);
+    return true;
+}
+
+QString MappedFile::errorString() const
+{
+    return m_file.errorString();
+}
+
+QString MappedFile::filePath() const
+{
+    return m_file.fileName();
+}
+
+qint64 MappedFile::size() const
+{
+    return m_size;
+}
+
+QByteArrayView MappedFile::data() const
+{
+    return QByteArrayView(reinterpret_cast<const char*>(m_data), m_size);
+}
+
+void MappedFile::setEncoding(QStringConverter::Encoding enc)
+{
+    m_encoding = enc;
+}
+
+bool MappedFile::supportsEncoding(QStringConverter::Encoding enc)
+{
+    //LF must be a single byte that never shows up inside a multi-byte sequence.
+    return enc == QStringConverter::Encoding::Utf8
+           || enc == QStringConverter::Encoding::Latin1
+           || enc == QStringConverter::Encoding::System;
+}
+
+qint64 MappedFile::lineCount() const
+{
+    return m_lineCount.load();
+}
+
+bool MappedFile::isIndexComplete() const
+{
+    return m_indexComplete.load();
+}
+
+void MappedFile::buildIndex()
+{
+    LineScanner scanner(reinterpret_cast<const char*>(m_data), m_size, IndexStep);
+
+    auto publish = [&]() {
+        QMutexLocker locker(&m_indexMutex);
+        m_checkpoints += scanner.takeLineStarts();
+        m_lineCount.store(scanner.lineCount()); //Published after the checkpoints so readers never see a line without its offset.
+    };
+
+    while (scanner.position() < m_size && !m_stop.load(std::memory_order_relaxed))
+    {
+        scanner.scan(scanner.position() + ReportBytes);
+        publish();
+        emit indexProgress(scanner.lineCount());
+    }
+
+    publish();
+    if (!m_stop.load())
+    {
+        {
+            QMutexLocker locker(&m_indexMutex);
+            m_lineEnding = scanner.lineEnding();
+        }
+        m_indexComplete.store(true);
+        emit indexFinished(scanner.lineCount());
+    }
+}
+
+QString MappedFile::lineEnding() const
+{
+    QMutexLocker locker(&m_indexMutex);
+    return m_lineEnding;
+}
+
+qint64 MappedFile::lineEnd(qint64 from) const
+{
+    const char *p = reinterpret_cast<const char*>(m_data);
+    for (qint64 i = from; i < m_size; i++)
+    {
+        if (p[i] == '\n' || p[i] == '\r')
+            return i;
+    }
+    return m_size;
+}
+
+qint64 MappedFile::nextLineStart(qint64 end) const
+{
+    //Same breaks as LineScanner: CR LF, lone CR, lone LF.
+    const char *p = reinterpret_cast<const char*>(m_data);
+    if (end >= m_size)
+        return -1;
+    if (p[end] == '\r' && end + 1 < m_size && p[end + 1] == '\n')
+        return end + 2;
+    return end + 1;
+}
+
+qint64 MappedFile::lineOffset(qint64 line) const
+{
+    if (line < 0 || line >= m_lineCount.load())
+        return -1;
+
+    qint64 offset;
+    {
+        QMutexLocker locker(&m_indexMutex);
+        offset = m_checkpoints.at(line / IndexStep);
+    }
+
+    //Walk the few lines between the checkpoint and the target.
+    for (qint64 k = line % IndexStep; k > 0 && offset >= 0; --k)
+        offset = nextLineStart(lineEnd(offset));
+    return offset;
+}
+
+qint64 MappedFile::lineAt(qint64 offset) const
+{
+    if (offset < 0 || offset >= m_size)
+        return -1;
+
+    qint64 line;
+    qint64 start;
+    {
+        QMutexLocker locker(&m_indexMutex);
+        if (m_checkpoints.isEmpty())
+            return -1;
+        //Last checkpoint at or before offset, a binary search over the sorted offsets.
+        auto it = std::upper_bound(m_checkpoints.cbegin(), m_checkpoints.cend(), offset);
+        qint64 k = (it - m_checkpoints.cbegin()) - 1;
+        line = k * IndexStep;
+        start = m_checkpoints.at(k);
+    }
+
+    //Walk the few lines after the checkpoint; more than IndexStep means offset is past the indexed part.
+    qint64 next = nextLineStart(lineEnd(start));
+    for (qint64 k = 0; next >= 0 && next <= offset; k++, next = nextLineStart(lineEnd(next)))
+    {
+        if (k == IndexStep)
+            return -1;
+        line++;
+    }
+    return line < m_lineCount.load() ? line : -1;
+}
+
+QString MappedFile::readLines(qint64 firstLine, int count) const
+{
+    qint64 offset = lineOffset(firstLine);
+    if (offset < 0)
+        return QString();
+
+    const char *p = reinterpret_cast<const char*>(m_data);
+    QString out;
+
+    //Skip a UTF-8 BOM, a full-file decoder would have dropped it too.
+    if (offset == 0 && m_encoding == QStringConverter::Encoding::Utf8 && m_size >= 3 && std::memcmp(p, "\xEF\xBB\xBF", 3) == 0)
+        offset = 3;
+
+    for (int i = 0; i < count && offset >= 0; i++)
+    {
+        qint64 end = lineEnd(offset);
+
+        if (i > 0)
+            out += QLatin1Char('\n');
+
+        QStringDecoder decoder(m_encoding, QStringConverter::Flag::Stateless); //Lines are decoded independently, a cut line must not leak state.
+        out += decoder.decode(QByteArrayView(p + offset, qMin(end - offset, MaxLineBytes)));
+
+        offset = nextLineStart(end);
+    }
+    return out;
+}
@@ -0,0 +1,86 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+/*
+ * Edito - A modern, cross-platform text editor
+ * Copyright (C) 2025 Yovsky <Yovsky@proton.me>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <QObject>
+#include <QFile>
+#include <QString>
+#include <QByteArrayView>
+#include <QStringConverter>
+#include <QMutex>
+#include <QList>
+#include <QThread>
+#include <atomic>
+
+// Read-only, memory-mapped view of a file too large to decode as a whole.
+// A sparse line index (one offset every IndexStep lines) is built on a
+// background thread; only the lines asked for are ever decoded.
+// Lines are split on single CR/LF bytes, so only byte-oriented encodings are supported.
+class MappedFile : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr qint64 IndexStep = 1024; //Lines between two stored offsets.
+    static constexpr qint64 MaxLineBytes = 64 * 1024; //Longer lines are cut when decoded.
+
+    explicit MappedFile(const QString &filePath, QObject *parent = nullptr);
+    ~MappedFile();
+
+    bool open(); //Maps the file and starts indexing.
+    QString errorString() const;
+    QString filePath() const;
+    qint64 size() const;
+    QByteArrayView data() const;
+
+    void setEncoding(QStringConverter::Encoding enc);
+    static bool supportsEncoding(QStringConverter::Encoding enc);
+
+    qint64 lineCount() const; //Lines indexed so far.
+    bool isIndexComplete() const;
+    qint64 lineOffset(qint64 line) const; //-1 if the line is not indexed (yet).
+    qint64 lineAt(qint64 offset) const; //Line holding the byte at offset, -1 if not indexed (yet).
+    QString lineEnding() const; //Empty until the index is complete.
+    QString readLines(qint64 firstLine, int count) const;
+
+private:
+    void buildIndex();
+    qint64 lineEnd(qint64 from) const; //Offset of the line break ending the line at from.
+    qint64 nextLineStart(qint64 end) const; //-1 past the last line.
+
+    QFile m_file;
+    const uchar *m_data;
+    qint64 m_size;
+    QStringConverter::Encoding m_encoding;
+
+    mutable QMutex m_indexMutex;
+    QList<qint64> m_checkpoints; //Offset of lines 0, IndexStep, 2*IndexStep...
+    QString m_lineEnding;
+    std::atomic<qint64> m_lineCount;
+    std::atomic<bool> m_indexComplete;
+    std::atomic<bool> m_stop;
+    QThread *m_indexer;
+
+signals:
+    void indexProgress(qint64 lines); //Emitted from the indexing thread.
+    void indexFinished(qint64 lines);
+};
+
+#endif // MAPPEDFILE_H
@@ -0,0 +1,126 @@
+/*
+ * Edito - A modern, cross-platform text editor
+ * Copyright (C) 2025 Yovsky <Yovsky@proton.me>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "spellcache.h"
+#include <QMutexLocker>
+
+SpellCache::SpellCache()
+    : m_generation(0)
+    , m_hits(0)
+    , m_misses(0)
+    , m_evictions(0)
+{
+}
+
+SpellCache::Shard &SpellCache::shardFor(const QByteArray &word)
+{
+    return m_shards[qHash(word) % Shards];
+}
+
+bool SpellCache::lookup(QByteArrayView word, bool &correct)
+{
+    if (word.size() > MaxWordBytes)
+        return false; //Not counted, it could never have been a hit.
+
+    const QByteArray key = QByteArray::fromRawData(word.data(), word.size()); //Borrows the bytes, no copy.
+    Shard &shard = shardFor(key);
+    {
+        QMutexLocker locker(&shard.mutex);
+        auto it = shard.index.constFind(key);
+        if (it != shard.index.constEnd())
+        {
+            Entry &entry = shard.entries[it.value()];
+            entry.referenced = true;
+            correct = entry.correct;
+            m_hits.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    m_misses.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+void SpellCache::insert(QByteArrayView word, bool correct, int generation)
+{
+    if (word.size() > MaxWordBytes)
+        return;
+
+    const QByteArray key = word.toByteArray(); //Owned copy, the caller's buffer is reused.
+    Shard &shard = shardFor(key);
+    QMutexLocker locker(&shard.mutex);
+    //Checked in the lock: invalidate() clears each shard under its lock after bumping the generation.
+    if (generation != m_generation.load(std::memory_order_acquire))
+        return;
+
+    auto it = shard.index.constFind(key);
+    if (it != shard.index.constEnd())
+    {
+        shard.entries[it.value()].correct = correct; //Another worker checked it meanwhile.
+        return;
+    }
+    if (shard.entries.size() < ShardCapacity)
+    {
+        shard.index.insert(key, int(shard.entries.size()));
+        shard.entries.append({key, correct, false});
+        return;
+    }
+
+    //Second chance: marked entries lose their mark, the first unmarked one goes. At most one turn.
+    while (shard.entries[shard.hand].referenced)
+    {
+        shard.entries[shard.hand].referenced = false;
+        shard.hand = (shard.hand + 1) % ShardCapacity;
+    }
+    Entry &victim = shard.entries[shard.hand];
+    shard.index.remove(victim.word);
+    victim = {key, correct, false};
+    shard.index.insert(key, shard.hand);
+    shard.hand = (shard.hand + 1) % ShardCapacity;
+    m_evictions.fetch_add(1, std::memory_order_relaxed);
+}
+
+int SpellCache::generation() const
+{
+    return m_generation.load(std::memory_order_acquire);
+}
+
+void SpellCache::invalidate()
+{
+    m_generation.fetch_add(1, std::memory_order_acq_rel);
+    for (Shard &shard : m_shards)
+    {
+        QMutexLocker locker(&shard.mutex);
+        shard.index.clear();
+        shard.entries.clear();
+        shard.hand = 0;
+    }
+}
+
+SpellCache::Stats SpellCache::stats() const
+{
+    Stats s;
+    s.hits = m_hits.load(std::memory_order_relaxed);
+    s.misses = m_misses.load(std::memory_order_relaxed);
+    s.evictions = m_evictions.load(std::memory_order_relaxed);
+    for (const Shard &shard : m_shards)
+    {
+        QMutexLocker locker(&shard.mutex);
+        s.size += int(shard.index.size());
+    }
+    return s;
+}
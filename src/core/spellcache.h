@@ -0,0 +1,87 @@
+#ifndef SPELLCACHE_H
+#define SPELLCACHE_H
+
+/*
+ * Edito - A modern, cross-platform text editor
+ * Copyright (C) 2025 Yovsky <Yovsky@proton.me>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <atomic>
+
+// Bounded word -> verdict cache shared by the spell check workers. Words are
+// spread over shards, each with its own lock, so workers rarely wait on each
+// other. A full shard makes room with the CLOCK policy: lookups set a bit on
+// the entry, and the hand going round the shard spares (and clears) marked
+// entries, so words that keep being checked stay while one-off words go.
+// Verdicts belong to one dictionary generation: invalidate() starts a new
+// one, and verdicts computed against an older one are not stored.
+class SpellCache
+{
+public:
+    static constexpr int Shards = 16;
+    static constexpr int ShardCapacity = 4096; //Words per shard.
+    static constexpr int MaxWordBytes = 128; //Longer words are not cached.
+
+    struct Stats
+    {
+        quint64 hits = 0;
+        quint64 misses = 0;
+        quint64 evictions = 0;
+        int size = 0;
+    };
+
+    SpellCache();
+
+    // Key is the word's UTF-8 exactly as checked, case included: Hunspell's verdict depends on it.
+    bool lookup(QByteArrayView word, bool &correct); //False on a miss. Doesn't allocate.
+    void insert(QByteArrayView word, bool correct, int generation);
+
+    int generation() const; //Read before checking, pass it to insert().
+    void invalidate(); //Dictionary or user words changed.
+
+    Stats stats() const;
+
+private:
+    struct Entry
+    {
+        QByteArray word; //Shares its bytes with the index key.
+        bool correct;
+        bool referenced; //Looked up since the hand last went past.
+    };
+
+    struct Shard
+    {
+        mutable QMutex mutex;
+        QHash<QByteArray, int> index; //Word -> slot in entries.
+        QList<Entry> entries; //The clock, filled up to ShardCapacity.
+        int hand = 0; //Next slot considered for eviction.
+    };
+
+    Shard &shardFor(const QByteArray &word);
+
+    Shard m_shards[Shards];
+    std::atomic<int> m_generation;
+    std::atomic<quint64> m_hits;
+    std::atomic<quint64> m_misses;
+    std::atomic<quint64> m_evictions;
+};
+
+#endif // SPELLCACHE_H
@@ -1,4 +1,16 @@
 #include "spellchecker.h"
+#include "spellstate.h"
+#include "updatescheduler.h"
+#include <third-party/hunspell/suggestindex.hxx>
+#include <QThread>
+#include <QDir>
+#include <QFileInfo>
+#include <QStandardPaths>
+#include <memory>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <utility>
 
 SpellChecker::SpellChecker(QObject *parent)
     : QObject{parent}
@@ -14,71 +26,450 @@ SpellChecker::SpellChecker(QObject *parent)
     qDebug() << QFile::exists(affPath);
     qDebug() << QFile::exists(dicPath);
 
-    m_spell = new Hunspell(
-        affPath.toUtf8().constData(),
-        dicPath.toUtf8().constData());
+    m_affPath = affPath.toUtf8();
+    m_dicPath = dicPath.toUtf8();
+
+    // the dictionary loads in the background once the event loop runs, so the first window doesn't wait for it
+    QTimer::singleShot(0, this, &SpellChecker::LoadDictionary);
+
+    // a few workers, each loads its own Hunspell (it is not thread safe), kept alive so the dictionary loads once per thread
+    m_pool.setMaxThreadCount(qBound(1, QThread::idealThreadCount() / 2, 4));
+    m_pool.setExpiryTimeout(-1);
+
+    m_idleTimer.setSingleShot(true);
+    m_idleTimer.setInterval(10);
+    connect(&m_idleTimer, &QTimer::timeout, this, &SpellChecker::CheckIdle);
+
+    // every job that comes back would otherwise hand the whole document's underlines to the editor again
+    m_underlineTimer.setSingleShot(true);
+    m_underlineTimer.setInterval(UpdateScheduler::FrameInterval);
+    connect(&m_underlineTimer, &QTimer::timeout, this, &SpellChecker::ApplyUnderlines);
 
     m_errorSpellFormat.setUnderlineStyle(QTextCharFormat::WaveUnderline);
     m_errorSpellFormat.setUnderlineColor(Qt::red);
 }
 
+SpellChecker::~SpellChecker()
+{
+    if (m_loader)
+    {
+        m_loader->wait(); // it writes m_spell
+        delete m_loader;
+    }
+    if (m_indexer)
+    {
+        m_suggestIndex->cancel();
+        m_indexer->wait(); // it builds m_suggestIndex out of m_spell's dictionaries
+        delete m_indexer;
+    }
+    delete m_suggestIndex;
+    m_pool.clear();
+    m_pool.waitForDone();
+
+    SpellCache::Stats stats = m_cache.stats();
+    qDebug() << "spell cache: hits" << stats.hits << "misses" << stats.misses
+             << "evictions" << stats.evictions << "size" << stats.size;
+    if (m_spell)
+    {
+        size_t lookups, misses, rejected;
+        m_spell->lookup_stats(&lookups, &misses, &rejected);
+        qDebug() << "suggestion dictionary lookups" << lookups << "absent" << misses
+                 << "rejected by the bloom filter" << rejected;
+    }
+    delete m_spell;
+}
+
+void SpellChecker::LoadDictionary()
+{
+    if (m_loader || m_ready) return;
+
+    m_loader = QThread::create([this]() {
+        QByteArray image = DictionaryImage().toUtf8();
+        if (!image.isEmpty())
+            m_suggestIndexPath = QString::fromUtf8(image.left(image.size() - 4)) + ".hsi";
+        if (!image.isEmpty() && Hunspell::is_dic_image(image.constData()))
+        {
+            m_spell = new Hunspell(m_affPath.constData(), image.constData());
+        }
+        else
+        {
+            m_spell = new Hunspell(m_affPath.constData(), m_dicPath.constData());
+            if (!image.isEmpty() && !SaveDictionaryImage(QString::fromUtf8(image)))
+                image.clear();
+        }
+        // workers load the image too; they only start once DictionaryLoaded has run, after this thread is done
+        if (!image.isEmpty())
+            m_dicPath = image;
+    });
+    connect(m_loader, &QThread::finished, this, &SpellChecker::DictionaryLoaded);
+    m_loader->start(QThread::LowPriority);
+}
+
+QString SpellChecker::DictionaryImage() const
+{
+    // named after the sources, a changed .dic or .aff gets a new image and the old one is never read again
+    QFileInfo dic(QString::fromUtf8(m_dicPath));
+    QFileInfo aff(QString::fromUtf8(m_affPath));
+    QString dir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    if (dir.isEmpty() || !dic.exists() || !aff.exists())
+        return QString();
+
+    return dir + "/dictionaries/" + dic.completeBaseName()
+           + '-' + QString::number(dic.size())
+           + '-' + QString::number(dic.lastModified().toSecsSinceEpoch())
+           + '-' + QString::number(aff.lastModified().toSecsSinceEpoch()) + ".hdi";
+}
+
+bool SpellChecker::SaveDictionaryImage(const QString &image)
+{
+    QFileInfo info(image);
+    QDir dir(info.absolutePath());
+    if (!dir.mkpath("."))
+        return false;
+
+    // images and suggestion indexes of older versions of the same dictionary
+    QString prefix = QFileInfo(QString::fromUtf8(m_dicPath)).completeBaseName() + '-';
+    for (const QString &old : dir.entryList({prefix + "*.hdi", prefix + "*.hdi.tmp", prefix + "*.hsi", prefix + "*.hsi.tmp"}, QDir::Files))
+        dir.remove(old);
+
+    // written aside and renamed, another instance never reads a half written image
+    QString temp = image + ".tmp";
+    if (!m_spell->save_dic_image(temp.toUtf8().constData()) || !QFile::rename(temp, image))
+    {
+        QFile::remove(temp);
+        return false;
+    }
+    qDebug() << "dictionary image saved to" << image;
+    return true;
+}
+
+void SpellChecker::DictionaryLoaded()
+{
+    m_loader->deleteLater();
+    m_loader = nullptr;
+
+    {
+        QMutexLocker locker(&m_userWordsMutex);
+        for (const QString &word : std::as_const(m_userWords))
+            m_spell->add(word.toStdString());
+    }
+    m_ready = true;
+    qDebug() << "dictionary loaded";
+    emit dictionaryReady();
+}
+
+void SpellChecker::BuildSuggestIndex()
+{
+    m_indexStarted = true;
+    m_suggestIndex = m_spell->create_suggest_index();
+
+    // m_spell's dictionaries are only read; words added meanwhile are picked up by the suggestions on their own
+    m_indexer = QThread::create([this]() {
+        if (!m_suggestIndexPath.isEmpty() && m_suggestIndex->load(m_suggestIndexPath.toUtf8().constData()))
+            return;
+        if (!m_suggestIndex->build() || m_suggestIndexPath.isEmpty())
+            return;
+
+        // written aside and renamed like the image
+        QString temp = m_suggestIndexPath + ".tmp";
+        if (!m_suggestIndex->save(temp.toUtf8().constData()) || !QFile::rename(temp, m_suggestIndexPath))
+            QFile::remove(temp);
+    });
+    connect(m_indexer, &QThread::finished, this, &SpellChecker::SuggestIndexReady);
+    m_indexer->start(QThread::LowPriority);
+}
+
+void SpellChecker::SuggestIndexReady()
+{
+    m_indexer->deleteLater();
+    m_indexer = nullptr;
+
+    if (m_suggestIndex->is_ready())
+    {
+        qDebug() << "suggestion index ready:" << m_suggestIndex->get_root_count() << "roots,"
+                 << m_suggestIndex->get_memory_size() / 1024 << "KiB";
+        m_spell->set_suggest_index(m_suggestIndex); // owned by m_spell from now on
+    }
+    else
+    {
+        delete m_suggestIndex;
+    }
+    m_suggestIndex = nullptr;
+}
+
+bool SpellChecker::IsReady() const
+{
+    return m_ready;
+}
+
 void SpellChecker::Check(CodeEditor* editor)
 {
-    if (!editor) return;
-    QString content = editor->document()->toPlainText();
+    // nothing to check against until the dictionary is loaded, background tabs wait until they are shown
+    if (!editor || !m_ready || !editor->isVisible()) return;
+
+    SpellState *state = SpellState::of(editor->document());
+
+    // the blocks on screen first, then a page above and below
+    QTextDocument *document = editor->document();
+    const QPair<QTextBlock, QTextBlock> visible = editor->visibleBlockRange();
+    const QTextBlock &first = visible.first;
+    const QTextBlock &last = visible.second;
+    if (first.isValid() && last.isValid())
+    {
+        const int page = qMax(1, last.blockNumber() - first.blockNumber() + 1);
+        Queue(editor, state->takeBlocks(first, last), VisiblePriority);
+        Queue(editor, state->takeBlocks(document->findBlockByNumber(qMax(0, first.blockNumber() - page)),
+                                        document->findBlockByNumber(qMin(document->blockCount() - 1, last.blockNumber() + page))),
+              MarginPriority);
+    }
+
+    // the rest of the document in idle slices
+    m_idleEditor = editor;
+    if (state->hasDirtyBlocks())
+        m_idleTimer.start();
+}
+
+void SpellChecker::CheckIdle()
+{
+    if (!m_idleEditor || !m_idleEditor->isVisible())
+        return; // picked up again when a tab is shown
+
+    SpellState *state = SpellState::of(m_idleEditor->document());
+    while (m_idleJobs < m_pool.maxThreadCount() && state->hasDirtyBlocks())
+    {
+        QList<QTextBlock> blocks = state->takeIdleBlocks(JobChars);
+        if (blocks.isEmpty())
+        {
+            m_idleTimer.start(); // only walked over checked blocks, go on in the next slice
+            return;
+        }
+        Queue(m_idleEditor, blocks, IdlePriority);
+    }
+    // the next slice goes out when one of these comes back
+}
+
+void SpellChecker::Queue(CodeEditor *editor, const QList<QTextBlock> &blocks, int priority)
+{
+    // the block text is copied here, in jobs of about JobChars characters
+    QList<SpellJobBlock> job;
+    int jobChars = 0;
+    for (const QTextBlock &block : blocks)
+    {
+        SpellJobBlock b;
+        b.number = block.blockNumber();
+        b.ticket = SpellState::ticket(block);
+        b.revision = block.revision();
+        b.text = block.text();
+        jobChars += b.text.size();
+        job.append(b);
+
+        if (jobChars >= JobChars)
+        {
+            Submit(editor, job, priority);
+            job.clear();
+            jobChars = 0;
+        }
+    }
+    if (!job.isEmpty())
+        Submit(editor, job, priority);
+}
+
+void SpellChecker::Submit(CodeEditor *editor, QList<SpellJobBlock> blocks, int priority)
+{
+    if (priority == IdlePriority)
+        m_idleJobs++;
 
-    m_misspelled.clear();
+    QPointer<CodeEditor> target(editor);
+    QPointer<QTextDocument> document(editor->document());
+    const int generation = m_cache.generation();
+    m_pool.start([this, target, document, blocks, priority, generation]() mutable {
+        SpellBlocks(blocks);
+        // back to the GUI thread, dropped if the checker is gone
+        QMetaObject::invokeMethod(this, [this, target, document, blocks, priority, generation]() {
+            // results are only taken back into the document they came from, and a dictionary change requeued everything
+            if (target && document && target->document() == document && generation == m_cache.generation())
+                ApplyResults(target, blocks);
+            if (priority == IdlePriority)
+            {
+                m_idleJobs--;
+                m_idleTimer.start();
+            }
+        }, Qt::QueuedConnection);
+    }, priority);
+}
 
-    QList<QTextEdit::ExtraSelection> selections;
-    QList<WordInfo> wordList = GetList(content);
+void SpellChecker::SpellBlocks(QList<SpellJobBlock> &blocks)
+{
+    // one Hunspell per worker thread, loaded on its first job
+    thread_local std::unique_ptr<Hunspell> spell;
+    thread_local int userWords = 0; // how many of m_userWords this thread's handle has
+    if (!spell)
+        spell.reset(new Hunspell(m_affPath.constData(), m_dicPath.constData()));
 
-    for (const WordInfo &w : wordList)
+    // generation first: a word added after this point makes the verdicts below stale, and the cache drops them
+    const int generation = m_cache.generation();
     {
-        if (m_spell->spell(w.word.toStdString()) == 0)
+        QMutexLocker locker(&m_userWordsMutex);
+        for (; userWords < m_userWords.size(); userWords++)
+            spell->add(m_userWords.at(userWords).toStdString());
+    }
+
+    // reused for every job, so words are found and converted to UTF-8 without allocating
+    thread_local SpellTokenizer tokenizer;
+    thread_local QByteArray packed; // cache misses, NUL-terminated back to back, for one spell_batch() call
+    thread_local QList<QPair<int, int>> unique; // offset and length in packed of each distinct missed word
+    thread_local QList<PendingWord> pending;
+    thread_local std::vector<uint64_t> verdicts;
+
+    // the missed words are at most the whole text, 4 bytes per UTF-16 unit with their NULs, so packed never moves
+    qsizetype textSize = 0;
+    for (const SpellJobBlock &b : std::as_const(blocks))
+        textSize += b.text.size();
+    packed.resize(0);
+    packed.reserve(textSize * 4 + 1);
+    unique.clear();
+    pending.clear();
+    QHash<QByteArray, int> uniqueIndex; // views into packed, a word missed twice in a job is checked once
+
+    for (int i = 0; i < blocks.size(); i++)
+    {
+        SpellJobBlock &b = blocks[i];
+        tokenizer.tokenize(b.text);
+        for (const SpellWord &w : tokenizer.words())
         {
-            // add misspelled word to the misspelled list
-            m_misspelled.append(w);
+            const QByteArrayView utf8 = tokenizer.utf8(w);
+            bool correct;
+            if (m_cache.lookup(utf8, correct))
+            {
+                if (!correct)
+                    b.misspellings.append(qMakePair(w.start, w.length));
+                continue;
+            }
+
+            auto it = uniqueIndex.constFind(QByteArray::fromRawData(utf8.data(), utf8.size()));
+            int index;
+            if (it != uniqueIndex.constEnd())
+            {
+                index = it.value();
+            }
+            else
+            {
+                index = int(unique.size());
+                unique.append(qMakePair(int(packed.size()), int(utf8.size())));
+                packed.append(utf8.data(), utf8.size());
+                packed.append('\0');
+                uniqueIndex.insert(QByteArray::fromRawData(packed.constData() + unique.last().first, utf8.size()), index);
+            }
+            pending.append(PendingWord{i, w.start, w.length, index});
+        }
+    }
 
+    if (unique.isEmpty())
+        return;
+
+    // every miss of the job in one call
+    verdicts.assign((unique.size() + 63) / 64, 0);
+    spell->spell_batch(packed.constData(), size_t(unique.size()), verdicts.data());
+    auto isCorrect = [](int index) {
+        return (verdicts[index / 64] >> (index % 64)) & 1;
+    };
+
+    for (int index = 0; index < unique.size(); index++)
+        m_cache.insert(QByteArrayView(packed.constData() + unique.at(index).first, unique.at(index).second), isCorrect(index), generation);
+
+    bool added = false;
+    for (const PendingWord &p : std::as_const(pending))
+    {
+        if (!isCorrect(p.unique))
+        {
+            blocks[p.block].misspellings.append(qMakePair(p.start, p.length));
+            added = true;
+        }
+    }
+    // cached and batched misspellings were added in two rounds, the ranges must be sorted by start
+    if (added)
+    {
+        for (SpellJobBlock &b : blocks)
+            std::sort(b.misspellings.begin(), b.misspellings.end());
+    }
+}
+
+void SpellChecker::AddWord(const QString &word)
+{
+    if (word.isEmpty()) return;
+
+    {
+        QMutexLocker locker(&m_userWordsMutex);
+        m_userWords.append(word);
+    }
+    if (m_ready)
+        m_spell->add(word.toStdString()); // else added once it's loaded
+    m_cache.invalidate();
+    emit dictionaryChanged();
+}
+
+SpellCache::Stats SpellChecker::CacheStats() const
+{
+    return m_cache.stats();
+}
+
+void SpellChecker::ApplyResults(CodeEditor *editor, const QList<SpellJobBlock> &blocks)
+{
+    SpellState *state = SpellState::of(editor->document());
+    bool changed = false;
+
+    for (const SpellJobBlock &b : blocks)
+    {
+        // edited, moved or removed while the worker ran; the change queued it again
+        QTextBlock block = state->queuedBlock(b.number, b.ticket, b.revision);
+        if (!block.isValid())
+            continue;
+
+        const int position = block.position();
+        QList<QTextEdit::ExtraSelection> selections;
+        for (const QPair<int, int> &m : b.misspellings)
+        {
             // underline the misspelled word
             QTextEdit::ExtraSelection selection;
             QTextCursor markerCursor(editor->document());
 
-            markerCursor.setPosition(w.start);
-            markerCursor.setPosition(w.end, QTextCursor::KeepAnchor);
+            markerCursor.setPosition(position + m.first);
+            markerCursor.setPosition(position + m.first + m.second, QTextCursor::KeepAnchor);
 
             selection.format = m_errorSpellFormat;
             selection.cursor = markerCursor;
 
             selections.append(selection);
         }
+        changed |= state->setResult(block, b.misspellings, selections);
     }
 
-    // apply the underlining
-    editor->SetSpellcheckerSelections(selections);
+    // the underlining is applied with the next frame, along with the results of the other jobs back by then
+    if (!changed)
+        return;
+    if (!m_underlineEditors.contains(editor))
+        m_underlineEditors.append(editor);
+    if (!m_underlineTimer.isActive())
+        m_underlineTimer.start();
 }
 
-QList<WordInfo> SpellChecker::GetList(QString content)
+void SpellChecker::ApplyUnderlines()
 {
-    QRegularExpression regex("\\b\\w+\\b");
-    QRegularExpressionMatchIterator iterator = regex.globalMatch(content);
-
-    QList<WordInfo> res;
-    while (iterator.hasNext())
+    const QList<QPointer<CodeEditor>> editors = std::exchange(m_underlineEditors, {});
+    for (CodeEditor *editor : editors)
     {
-        QRegularExpressionMatch match = iterator.next();
-
-        WordInfo w;
-        w.word = match.captured();
-        w.start = match.capturedStart();
-        w.end = match.capturedEnd();
-        res.append(w);
+        if (editor) // closed meanwhile
+            editor->SetSpellcheckerSelections(SpellState::of(editor->document())->selections());
     }
-    return res;
 }
 
 QList<QString> SpellChecker::Suggest(CodeEditor* editor, QString word)
 {
     QList<QString> corrections;
+    if (!m_ready)
+        return corrections;
+    if (!m_indexStarted)
+        BuildSuggestIndex(); // this one still scans the dictionary, the next ones use the index once it's there
 
     // create and populate the suggestions list
     char **list = nullptr;
@@ -100,11 +491,6 @@ QList<QString> SpellChecker::Suggest(CodeEditor* editor, QString word)
 
 bool SpellChecker::IsMisspelled(CodeEditor* editor, qint64 pos)
 {
-    Check(editor);
-    for (WordInfo w : m_misspelled)
-    {
-        if (pos >= w.start && pos <= w.end)
-            return true;
-    }
-    return false;
+    // the stored result of this editor's document, nothing is checked here
+    return SpellState::of(editor->document())->isMisspelled(int(pos));
 }
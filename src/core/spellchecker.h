@@ -2,6 +2,8 @@
 #define SPELLCHECKER_H
 
 #include "src/ui/codeeditor.h"
+#include "spellcache.h"
+#include "spelltokenizer.h"
 #include <QObject>
 #include <third-party/hunspell/hunspell.hxx>
 #include <QDebug>
@@ -10,30 +12,89 @@
 #include <QTextCharFormat>
 #include <QCoreApplication>
 #include <QFile>
+#include <QThreadPool>
+#include <QPointer>
+#include <QTextBlock>
+#include <QTimer>
+#include <QThread>
+#include <QMutex>
+#include <QStringList>
 
-struct WordInfo
+// one block of a spell job, text copied on the GUI thread, result filled in by a worker
+struct SpellJobBlock
 {
-    QString word;
-    qint64 start;
-    qint64 end;
+    int number; // block number when queued, found again through SpellState::queuedBlock
+    quint64 ticket;
+    int revision;
+    QString text;
+    QList<QPair<int, int>> misspellings; // start and length in the block
+};
+
+// a word of a spell job missing from the cache, waiting for the batch verdict
+struct PendingWord
+{
+    int block; // index in the job
+    int start;
+    int length;
+    int unique; // index of its distinct word in the batch
 };
 
 class SpellChecker : public QObject
 {
     Q_OBJECT
 public:
+    static constexpr int JobChars = 32 * 1024; // characters per job handed to a worker
+
+    // pool priorities, the viewport jumps ahead of anything queued before it
+    enum JobPriority { IdlePriority = 0, MarginPriority = 1, VisiblePriority = 2 };
+
     explicit SpellChecker(QObject *parent = nullptr);
-    void Check(CodeEditor *editor);
-    QList<WordInfo> GetList(QString content);
+    ~SpellChecker();
+    void LoadDictionary(); // on a background thread, dictionaryReady() when done; called on its own once the event loop runs
+    bool IsReady() const;
+    void Check(CodeEditor *editor); // visible part now, the rest of the document in idle slices
     QList<QString> Suggest(CodeEditor *editor, QString word);
     bool IsMisspelled(CodeEditor *editor, qint64 pos);
+    void AddWord(const QString &word); // accepted for the rest of the session
+    SpellCache::Stats CacheStats() const;
 
 private:
-    Hunspell *m_spell = nullptr;
+    void Queue(CodeEditor *editor, const QList<QTextBlock> &blocks, int priority);
+    void Submit(CodeEditor *editor, QList<SpellJobBlock> blocks, int priority);
+    void CheckIdle();
+    void DictionaryLoaded();
+    QString DictionaryImage() const; // cached binary form of the .dic, empty if there is no cache directory
+    bool SaveDictionaryImage(const QString &image); // loader side
+    void BuildSuggestIndex(); // on the first Suggest(), in the background
+    void SuggestIndexReady();
+    void SpellBlocks(QList<SpellJobBlock> &blocks); // worker side
+    void ApplyResults(CodeEditor *editor, const QList<SpellJobBlock> &blocks);
+    void ApplyUnderlines(); // once per frame, for the editors whose results changed
+
+    Hunspell *m_spell = nullptr; // GUI thread only (suggestions), workers have their own; set by m_loader
+    QThread *m_loader = nullptr;
+    bool m_ready = false; // m_spell is loaded, nothing is checked before
+    QByteArray m_affPath;
+    QByteArray m_dicPath;
+    QString m_suggestIndexPath; // cache of the suggestion index, next to the image; empty without a cache directory
+    SuggestIndex *m_suggestIndex = nullptr; // filled by m_indexer, then owned by m_spell
+    QThread *m_indexer = nullptr;
+    bool m_indexStarted = false;
+    QThreadPool m_pool;
+    QTimer m_idleTimer;
+    QTimer m_underlineTimer;
+    QList<QPointer<CodeEditor>> m_underlineEditors; // results changed since the last ApplyUnderlines
+    QPointer<CodeEditor> m_idleEditor; // the editor the idle slices work on, the one last shown
+    int m_idleJobs = 0; // idle jobs in flight, kept to one per worker so the queue stays short
     QTextCharFormat m_errorSpellFormat;
-    QList<WordInfo> m_misspelled;
+
+    SpellCache m_cache; // verdicts shared by all workers
+    mutable QMutex m_userWordsMutex;
+    QStringList m_userWords; // added through AddWord, replayed into each worker's Hunspell
 
 signals:
+    void dictionaryChanged(); // results so far are stale, documents should be checked again
+    void dictionaryReady(); // checking can start, documents should be checked
 };
 
 #endif // SPELLCHECKER_H
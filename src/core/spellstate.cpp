@@ -0,0 +1,229 @@
+/*
+ * Edito - A modern, cross-platform text editor
+ * Copyright (C) 2025 Yovsky <Yovsky@proton.me>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "spellstate.h"
+#include <algorithm>
+
+namespace
+{
+constexpr int SweepBlocks = 4096; //Blocks walked per idle slice at most, checked ones included.
+}
+
+SpellBlockData::SpellBlockData(SpellState *owner)
+    : m_owner(owner)
+{
+}
+
+SpellBlockData::~SpellBlockData()
+{
+    if (m_owner) //Blocks are deleted with their text, or with the document after the state.
+        m_owner->m_marked.remove(this);
+}
+
+SpellState::SpellState(QTextDocument *document)
+    : QObject(document)
+    , m_document(document)
+    , m_sweep(0)
+    , m_blockCount(document->blockCount())
+{
+    setObjectName(QStringLiteral("SpellState"));
+    connect(document, &QTextDocument::contentsChange, this, &SpellState::contentsChanged);
+}
+
+SpellState *SpellState::of(QTextDocument *document)
+{
+    if (!document)
+        return nullptr;
+    SpellState *state = document->findChild<SpellState*>(QStringLiteral("SpellState"), Qt::FindDirectChildrenOnly);
+    return state ? state : new SpellState(document);
+}
+
+void SpellState::contentsChanged(int position, int charsRemoved, int charsAdded)
+{
+    Q_UNUSED(charsRemoved);
+
+    //Only the blocks the change landed in, the rest of the document keeps its results.
+    QTextBlock block = m_document->findBlock(position);
+    const int first = block.blockNumber();
+    if (m_document->blockCount() != m_blockCount)
+    {
+        //Lines added or removed shift the numbers after them; the sweep goes over that part again, it skips checked blocks.
+        m_blockCount = m_document->blockCount();
+        m_sweep = m_sweep >= 0 ? qMin(m_sweep, first) : first;
+        m_liveTickets = m_nextTicket; //Jobs out now may not find their block by number any more.
+    }
+    const int end = position + charsAdded;
+    for (; block.isValid() && block.position() <= end; block = block.next())
+        m_dirty.append(block.blockNumber());
+}
+
+void SpellState::markQueued(QTextBlock &block)
+{
+    SpellBlockData *data = dynamic_cast<SpellBlockData*>(block.userData());
+    if (!data)
+    {
+        data = new SpellBlockData(this);
+        block.setUserData(data); //Owned by the block from here on.
+    }
+    data->queued = block.revision();
+    data->ticket = m_nextTicket++;
+}
+
+QList<QTextBlock> SpellState::takeBlocks(const QTextBlock &first, const QTextBlock &last)
+{
+    QList<QTextBlock> blocks;
+    if (!first.isValid())
+        return blocks;
+
+    const int end = last.isValid() ? last.position() : first.position();
+    for (QTextBlock block = first; block.isValid() && block.position() <= end; block = block.next())
+    {
+        if (needsCheck(block))
+        {
+            markQueued(block);
+            blocks.append(block);
+        }
+    }
+    return blocks;
+}
+
+QList<QTextBlock> SpellState::takeIdleBlocks(int maxChars)
+{
+    QList<QTextBlock> blocks;
+    int chars = 0;
+
+    //Edits first, looked up again by number; past the end after lines were removed.
+    while (!m_dirty.isEmpty() && chars < maxChars)
+    {
+        QTextBlock block = m_document->findBlockByNumber(m_dirty.takeFirst());
+        if (block.isValid() && needsCheck(block))
+        {
+            markQueued(block);
+            blocks.append(block);
+            chars += block.length();
+        }
+    }
+
+    //Then the full pass, skipping what the viewport already got.
+    if (m_sweep >= 0 && chars < maxChars)
+    {
+        QTextBlock block = m_document->findBlockByNumber(m_sweep);
+        for (int walked = 0; block.isValid() && chars < maxChars && walked < SweepBlocks; block = block.next(), walked++)
+        {
+            if (needsCheck(block))
+            {
+                markQueued(block);
+                blocks.append(block);
+                chars += block.length();
+            }
+        }
+        m_sweep = block.isValid() ? block.blockNumber() : -1;
+    }
+    return blocks;
+}
+
+void SpellState::markAllDirty()
+{
+    m_sweep = 0;
+    m_dirty.clear();
+    for (QTextBlock block = m_document->begin(); block.isValid(); block = block.next())
+    {
+        if (SpellBlockData *data = dynamic_cast<SpellBlockData*>(block.userData()))
+        {
+            data->revision = -1;
+            data->queued = -1;
+        }
+    }
+}
+
+bool SpellState::hasDirtyBlocks() const
+{
+    return m_sweep >= 0 || !m_dirty.isEmpty();
+}
+
+bool SpellState::isChecked(const QTextBlock &block)
+{
+    SpellBlockData *data = dynamic_cast<SpellBlockData*>(block.userData());
+    return data && data->revision == block.revision();
+}
+
+bool SpellState::needsCheck(const QTextBlock &block) const
+{
+    SpellBlockData *data = dynamic_cast<SpellBlockData*>(block.userData());
+    return !data || (data->revision != block.revision() && (data->queued != block.revision() || data->ticket < m_liveTickets));
+}
+
+quint64 SpellState::ticket(const QTextBlock &block)
+{
+    SpellBlockData *data = dynamic_cast<SpellBlockData*>(block.userData());
+    return data ? data->ticket : 0;
+}
+
+QTextBlock SpellState::queuedBlock(int number, quint64 ticket, int revision) const
+{
+    //By number, not by a kept handle: a removed block's handle still looks valid and points into freed or reused storage.
+    QTextBlock block = m_document->findBlockByNumber(number);
+    SpellBlockData *data = block.isValid() ? dynamic_cast<SpellBlockData*>(block.userData()) : nullptr;
+    if (!data || data->ticket != ticket || block.revision() != revision)
+        return QTextBlock();
+    return block;
+}
+
+bool SpellState::setResult(QTextBlock &block, const QList<QPair<int, int>> &ranges, const QList<QTextEdit::ExtraSelection> &misspellings)
+{
+    SpellBlockData *data = dynamic_cast<SpellBlockData*>(block.userData());
+    if (!data)
+    {
+        data = new SpellBlockData(this);
+        block.setUserData(data); //Owned by the block from here on.
+    }
+    data->revision = block.revision();
+    data->ranges = ranges;
+    data->misspellings = misspellings;
+
+    if (misspellings.isEmpty())
+        return m_marked.remove(data); //Clean before and after, most blocks.
+    m_marked.insert(data);
+    return true;
+}
+
+QList<QTextEdit::ExtraSelection> SpellState::selections() const
+{
+    QList<QTextEdit::ExtraSelection> all;
+    for (const SpellBlockData *data : m_marked)
+        all += data->misspellings;
+    return all;
+}
+
+bool SpellState::isMisspelled(int position) const
+{
+    //The block through the document's block tree, then the misspelling starting at or before position.
+    QTextBlock block = m_document->findBlock(position);
+    if (!isChecked(block))
+        return false; //Edited and not checked yet, its ranges are out of date.
+
+    const QList<QPair<int, int>> &ranges = static_cast<SpellBlockData*>(block.userData())->ranges;
+    const int offset = position - block.position();
+    auto it = std::upper_bound(ranges.cbegin(), ranges.cend(), offset, [](int value, const QPair<int, int> &range) {
+        return value < range.first;
+    });
+    if (it == ranges.cbegin())
+        return false;
+    --it;
+    return offset <= it->first + it->second;
+}
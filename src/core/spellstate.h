@@ -0,0 +1,94 @@
+#ifndef SPELLSTATE_H
+#define SPELLSTATE_H
+
+/*
+ * Edito - A modern, cross-platform text editor
+ * Copyright (C) 2025 Yovsky <Yovsky@proton.me>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <QObject>
+#include <QList>
+#include <QSet>
+#include <QPointer>
+#include <QTextBlock>
+#include <QTextBlockUserData>
+#include <QTextDocument>
+#include <QTextEdit>
+
+class SpellState;
+
+// Spell check result of one block, valid while the block's revision is unchanged.
+// The underline cursors follow edits on their own until the block is checked again.
+class SpellBlockData : public QTextBlockUserData
+{
+public:
+    explicit SpellBlockData(SpellState *owner);
+    ~SpellBlockData() override;
+
+    int revision = -1; //QTextBlock::revision() the result belongs to.
+    int queued = -1; //Revision handed to a worker, so it isn't queued twice.
+    quint64 ticket = 0; //Given to the job with it, the result is only taken back under the same ticket.
+    QList<QPair<int, int>> ranges; //Start and length of each misspelling in the block, sorted by start.
+    QList<QTextEdit::ExtraSelection> misspellings; //The same ranges as underlines.
+
+private:
+    QPointer<SpellState> m_owner;
+};
+
+// Per-document spell bookkeeping: which blocks changed since they were last
+// checked, and where the misspellings are. Misspellings are kept per block,
+// relative to the block start, so the block tree keeps their positions
+// current through edits elsewhere and a lookup is two binary searches. Lives as a child of its
+// document, get it through of().
+// Blocks are handed out by range (the viewport first) or in idle slices:
+// edited blocks, then a sweep over the whole document. A block taken once
+// isn't handed out again until it changes.
+class SpellState : public QObject
+{
+    Q_OBJECT
+
+public:
+    static SpellState *of(QTextDocument *document); //Created on first use, with every block dirty.
+
+    QList<QTextBlock> takeBlocks(const QTextBlock &first, const QTextBlock &last); //Unchecked blocks from first to last.
+    QList<QTextBlock> takeIdleBlocks(int maxChars); //About maxChars worth of unchecked blocks, anywhere.
+    void markAllDirty(); //E.g. after the dictionary changed.
+    bool hasDirtyBlocks() const;
+
+    static bool isChecked(const QTextBlock &block); //Has a result for the block's current revision.
+    bool needsCheck(const QTextBlock &block) const; //Neither checked nor queued at its current revision.
+    static quint64 ticket(const QTextBlock &block); //Of the job the block was last handed to, 0 if none.
+    QTextBlock queuedBlock(int number, quint64 ticket, int revision) const; //The block a job was about, invalid if it was edited, moved or removed since.
+    bool setResult(QTextBlock &block, const QList<QPair<int, int>> &ranges, const QList<QTextEdit::ExtraSelection> &misspellings); //ranges sorted by start; false if the underlines stay as they were.
+    bool isMisspelled(int position) const; //Inside or at the end of a misspelling found by the last check.
+    QList<QTextEdit::ExtraSelection> selections() const; //Underlines of the whole document.
+
+private:
+    friend class SpellBlockData;
+    explicit SpellState(QTextDocument *document);
+    void contentsChanged(int position, int charsRemoved, int charsAdded);
+    void markQueued(QTextBlock &block);
+
+    QTextDocument *m_document;
+    int m_sweep; //Block number the full pass goes on from, -1 once done.
+    int m_blockCount; //As of the last change, tells edits within lines from lines added or removed.
+    quint64 m_nextTicket = 1;
+    quint64 m_liveTickets = 1; //Tickets below were handed out before lines were added or removed; their blocks may have moved, so they are queued again.
+    QList<int> m_dirty; //Numbers of the blocks edited since the sweep went past them. Handles aren't kept, a removed block's handle still looks valid.
+    QSet<SpellBlockData*> m_marked; //Blocks with at least one misspelling.
+};
+
+#endif // SPELLSTATE_H
@@ -0,0 +1,182 @@
+/*
+ * Edito - A modern, cross-platform text editor
+ * Copyright (C) 2025 Yovsky <Yovsky@proton.me>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "spelltokenizer.h"
+#include <QChar>
+
+namespace
+{
+struct AsciiTable
+{
+    bool word[128];
+
+    constexpr AsciiTable()
+        : word{}
+    {
+        for (int c = 0; c < 128; c++)
+            word[c] = (c >= '0' && c <= '9') || (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || c == '_';
+    }
+};
+
+constexpr AsciiTable Ascii;
+
+//Code point at i, a lone surrogate comes back as itself.
+inline char32_t codePointAt(const char16_t *text, int size, int i, int &units)
+{
+    const char16_t c = text[i];
+    if (QChar::isHighSurrogate(c) && i + 1 < size && QChar::isLowSurrogate(text[i + 1]))
+    {
+        units = 2;
+        return QChar::surrogateToUcs4(c, text[i + 1]);
+    }
+    units = 1;
+    return c;
+}
+
+inline char *putUtf8(char *out, char32_t c)
+{
+    if (c < 0x80)
+    {
+        *out++ = char(c);
+    }
+    else if (c < 0x800)
+    {
+        *out++ = char(0xC0 | (c >> 6));
+        *out++ = char(0x80 | (c & 0x3F));
+    }
+    else if (c < 0x10000)
+    {
+        *out++ = char(0xE0 | (c >> 12));
+        *out++ = char(0x80 | ((c >> 6) & 0x3F));
+        *out++ = char(0x80 | (c & 0x3F));
+    }
+    else
+    {
+        *out++ = char(0xF0 | (c >> 18));
+        *out++ = char(0x80 | ((c >> 12) & 0x3F));
+        *out++ = char(0x80 | ((c >> 6) & 0x3F));
+        *out++ = char(0x80 | (c & 0x3F));
+    }
+    return out;
+}
+}
+
+bool SpellTokenizer::isWordChar(char32_t c)
+{
+    if (c < 0x80)
+        return Ascii.word[c];
+
+    switch (QChar::category(c))
+    {
+    case QChar::Letter_Uppercase:
+    case QChar::Letter_Lowercase:
+    case QChar::Letter_Titlecase:
+    case QChar::Letter_Modifier:
+    case QChar::Letter_Other:
+    case QChar::Number_DecimalDigit:
+    case QChar::Number_Letter:
+    case QChar::Number_Other:
+    case QChar::Mark_NonSpacing: //Decomposed accents stay in their word.
+    case QChar::Punctuation_Connector:
+        return true;
+    default:
+        return false;
+    }
+}
+
+void SpellTokenizer::tokenize(QStringView text)
+{
+    const char16_t *p = text.utf16();
+    const int size = int(text.size());
+
+    m_words.clear(); //Keeps the capacity.
+    //Worst case: 3 bytes per UTF-16 unit (a surrogate pair makes 4 from 2) and a NUL per word, at most one word per unit.
+    m_arena.resize(qsizetype(size) * 4 + 1);
+    char *const arena = m_arena.data();
+    char *out = arena;
+
+    int i = 0;
+    while (i < size)
+    {
+        //Skip to the next word.
+        int units = 1;
+        while (i < size)
+        {
+            const char16_t c = p[i];
+            if (c < 0x80)
+            {
+                if (Ascii.word[c])
+                    break;
+                i++;
+            }
+            else
+            {
+                if (isWordChar(codePointAt(p, size, i, units)))
+                    break;
+                i += units;
+            }
+        }
+        if (i >= size)
+            break;
+
+        //Copy the word to the arena while finding its end.
+        SpellWord word;
+        word.start = i;
+        word.bytes = int(out - arena);
+        while (i < size)
+        {
+            const char16_t c = p[i];
+            if (c < 0x80)
+            {
+                if (!Ascii.word[c])
+                    break;
+                *out++ = char(c);
+                i++;
+            }
+            else
+            {
+                const char32_t u = codePointAt(p, size, i, units);
+                if (!isWordChar(u))
+                    break;
+                out = putUtf8(out, u);
+                i += units;
+            }
+        }
+        word.length = i - word.start;
+        word.byteLength = int(out - arena) - word.bytes;
+        *out++ = '\0';
+        m_words.append(word);
+    }
+
+    m_arena.resize(out - arena); //Never shrinks the capacity.
+}
+
+const QList<SpellWord> &SpellTokenizer::words() const
+{
+    return m_words;
+}
+
+QByteArrayView SpellTokenizer::utf8(const SpellWord &word) const
+{
+    return QByteArrayView(m_arena.constData() + word.bytes, word.byteLength);
+}
+
+const char *SpellTokenizer::utf8Data(const SpellWord &word) const
+{
+    return m_arena.constData() + word.bytes;
+}
@@ -0,0 +1,60 @@
+#ifndef SPELLTOKENIZER_H
+#define SPELLTOKENIZER_H
+
+/*
+ * Edito - A modern, cross-platform text editor
+ * Copyright (C) 2025 Yovsky <Yovsky@proton.me>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <QtGlobal>
+#include <QList>
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QStringView>
+
+// One word found by SpellTokenizer: where it is in the text, and where its
+// UTF-8 copy is in the tokenizer's arena.
+struct SpellWord
+{
+    int start; //UTF-16 offset in the text.
+    int length;
+    int bytes; //Offset of the UTF-8 copy in the arena, NUL-terminated.
+    int byteLength;
+};
+
+// Splits text into words (maximal runs of letters, digits, combining marks
+// and connector punctuation such as '_', like \w+ in a Unicode regex) and
+// writes each word as UTF-8 into one reusable arena, ready for Hunspell.
+// ASCII is classified through a table; only other characters go through
+// QChar's Unicode properties. Buffers keep their capacity between calls,
+// so a tokenizer reused across texts stops allocating once warmed up.
+class SpellTokenizer
+{
+public:
+    void tokenize(QStringView text); //Replaces the previous result.
+
+    const QList<SpellWord> &words() const;
+    QByteArrayView utf8(const SpellWord &word) const;
+    const char *utf8Data(const SpellWord &word) const; //NUL-terminated.
+
+    static bool isWordChar(char32_t c);
+
+private:
+    QList<SpellWord> m_words;
+    QByteArray m_arena;
+};
+
+#endif // SPELLTOKENIZER_H
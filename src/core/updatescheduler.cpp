@@ -0,0 +1,102 @@
+/*
+ * Edito - A modern, cross-platform text editor
+ * Copyright (C) 2025 Yovsky <Yovsky@proton.me>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "updatescheduler.h"
+
+UpdateScheduler::UpdateScheduler(QObject *parent)
+    : QObject(parent)
+    , m_dirty(0)
+{
+    m_timer.setSingleShot(true);
+    m_timer.setInterval(FrameInterval);
+    connect(&m_timer, &QTimer::timeout, this, &UpdateScheduler::flush);
+}
+
+void UpdateScheduler::setHandler(quint32 part, std::function<void()> handler)
+{
+    for (Part &p : m_parts)
+    {
+        if (p.bit == part)
+        {
+            p.handler = std::move(handler);
+            return;
+        }
+    }
+    Part p;
+    p.bit = part;
+    p.handler = std::move(handler);
+    m_parts.append(p);
+}
+
+void UpdateScheduler::invalidate(quint32 parts)
+{
+    for (Part &p : m_parts)
+    {
+        if (parts & p.bit)
+            p.requested++;
+    }
+
+    m_dirty |= parts;
+    if (!m_timer.isActive())
+        m_timer.start();
+}
+
+void UpdateScheduler::flush()
+{
+    m_timer.stop();
+
+    //Handlers run in registration order; anything they invalidate goes to the next frame.
+    const quint32 dirty = m_dirty;
+    m_dirty = 0;
+    for (Part &p : m_parts)
+    {
+        if ((dirty & p.bit) && p.handler)
+        {
+            p.performed++;
+            p.handler();
+        }
+    }
+}
+
+quint64 UpdateScheduler::requested(quint32 part) const
+{
+    for (const Part &p : m_parts)
+    {
+        if (p.bit == part)
+            return p.requested;
+    }
+    return 0;
+}
+
+quint64 UpdateScheduler::performed(quint32 part) const
+{
+    for (const Part &p : m_parts)
+    {
+        if (p.bit == part)
+            return p.performed;
+    }
+    return 0;
+}
+
+quint64 UpdateScheduler::absorbed() const
+{
+    quint64 total = 0;
+    for (const Part &p : m_parts)
+        total += p.requested - p.performed;
+    return total;
+}
@@ -0,0 +1,61 @@
+#ifndef UPDATESCHEDULER_H
+#define UPDATESCHEDULER_H
+
+/*
+ * Edito - A modern, cross-platform text editor
+ * Copyright (C) 2025 Yovsky <Yovsky@proton.me>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <QObject>
+#include <QTimer>
+#include <QList>
+#include <functional>
+
+// Coalesces UI refreshes. Parts of the UI are bits of a mask; anything that
+// changes their state calls invalidate(), and every dirty part's handler runs
+// once when the next frame is due, however many times it was invalidated.
+class UpdateScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr int FrameInterval = 16; //Milliseconds, about one frame at 60 Hz.
+
+    explicit UpdateScheduler(QObject *parent = nullptr);
+
+    void setHandler(quint32 part, std::function<void()> handler); //part: a single bit.
+    void invalidate(quint32 parts);
+    void flush(); //Run the dirty handlers now.
+
+    quint64 requested(quint32 part) const; //invalidate() calls naming the part.
+    quint64 performed(quint32 part) const; //Times its handler actually ran.
+    quint64 absorbed() const; //Requests merged into an update already pending, all parts.
+
+private:
+    struct Part
+    {
+        quint32 bit;
+        std::function<void()> handler;
+        quint64 requested = 0;
+        quint64 performed = 0;
+    };
+
+    QList<Part> m_parts;
+    quint32 m_dirty;
+    QTimer m_timer;
+};
+
+#endif // UPDATESCHEDULER_H
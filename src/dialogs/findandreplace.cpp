@@ -78,6 +78,10 @@ void FindAndReplace::Find()
 
 void FindAndReplace::Replace()
 {
+    // cursor edits go through even on a read-only editor (large file viewers included)
+    if (m_editor->isReadOnly())
+        return;
+
     QTextCursor cursor = m_editor->textCursor();
     QString text = GetReplaceText();
     cursor.insertText(text);
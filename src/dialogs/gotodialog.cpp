@@ -36,8 +36,8 @@ gotodialog::gotodialog(CodeEditor *editor, QWidget *parent)
         toggleLineOffs();
     });
 
-    lengthLine = editor->document()->lineCount();
-    lengthChar = editor->document()->characterCount();
+    lengthLine = editor->totalLineCount(); //Lines, not wrapped rows.
+    lengthChar = editor->totalLength();
 
     toggleLineOffs();
 }
@@ -50,15 +50,15 @@ void gotodialog::toggleLineOffs()
     {
         QRegularExpressionValidator *validator = new QRegularExpressionValidator(QRegularExpression("\\d{0," + QString::number(QString::number(lengthLine).length()) + "}"), this);
         ui->Go_to->setValidator(validator);
-        ui->Max->setText(QString::number(lengthLine + 1));
-        ui->Current->setText(QString::number(editor->textCursor().blockNumber() + 1));
+        ui->Max->setText(QString::number(lengthLine));
+        ui->Current->setText(QString::number(editor->currentLine() + 1));
     }
     else
     {
         QRegularExpressionValidator *validator = new QRegularExpressionValidator(QRegularExpression("\\d{0," + QString::number(QString::number(lengthChar).length()) + "}"), this);
         ui->Go_to->setValidator(validator);
         ui->Max->setText(QString::number(lengthChar + 1));
-        ui->Current->setText(QString::number(editor->textCursor().position() + 1));
+        ui->Current->setText(QString::number(editor->currentOffset() + 1));
     }
 }
 
@@ -86,18 +86,11 @@ void gotodialog::on_Off_m_toggled(bool checked)
 
 void gotodialog::executeGoTo()
 {
-    QTextCursor cursor = editor->textCursor();
-    int target = ui->Go_to->text().toInt() - 1;
-    if(line_M && target <= lengthLine)
-    {
-        cursor.setPosition(0);
-        cursor.movePosition(QTextCursor::Down, QTextCursor::MoveAnchor, target);
-    }
-    else if(!line_M && target + 1 <= lengthChar)
-        cursor.setPosition(target + 1);
+    qint64 target = ui->Go_to->text().toLongLong() - 1;
+    if(line_M)
+        editor->goToLine(target); //Tree lookup, out of range targets are clamped.
     else
-        cursor.setPosition(lengthChar - 1);
-    editor->setTextCursor(cursor);
+        editor->goToOffset(target);
 }
 
 void gotodialog::on_Ok_clicked()
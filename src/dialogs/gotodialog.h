@@ -48,8 +48,8 @@ private slots:
 private:
     Ui::gotodialog *ui;
     CodeEditor *editor;
-    int lengthChar;
-    int lengthLine;
+    qint64 lengthChar;
+    qint64 lengthLine;
     bool line_M;
 };
 
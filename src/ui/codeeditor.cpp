@@ -18,10 +18,13 @@
 
 #include "codeeditor.h"
 #include "editor.h"
+#include "src/core/spellstate.h"
 #include <QPainter>
 #include <QTextBlock>
+#include <QTextLayout>
 #include <QColor>
 #include <QMenu>
+#include <QScrollBar>
 
 CodeEditor::CodeEditor(QWidget *parent, SpellChecker *checker)
     : QPlainTextEdit(parent)
@@ -45,11 +48,21 @@ CodeEditor::CodeEditor(QWidget *parent, SpellChecker *checker)
     connect(this, &CodeEditor::updateRequest, this, &CodeEditor::updateLineNumberArea);
     connect(this, &CodeEditor::cursorPositionChanged, this, &CodeEditor::highlightCurrentLine);
     connect(this, &CodeEditor::selectionChanged, this, &CodeEditor::highlightCurrentLine);
+    connect(document(), &QTextDocument::contentsChange, this, &CodeEditor::documentContentsChanged);
     connect(this, &CodeEditor::selectionChanged, this, &CodeEditor::onSelectionChanged);
     connect(this, &CodeEditor::textChanged, this, &CodeEditor::UpdateUserInputTimer);
     connect(userInputTimer, &QTimer::timeout, [=] () {
         CallSpellChecker();
     });
+    connect(verticalScrollBar(), &QScrollBar::valueChanged, this, &CodeEditor::CallSpellChecker); //Newly shown lines go ahead of the background pass.
+    if (m_checker)
+    {
+        connect(m_checker, &SpellChecker::dictionaryChanged, this, [=]() {
+            SpellState::of(document())->markAllDirty();
+            CallSpellChecker();
+        });
+        connect(m_checker, &SpellChecker::dictionaryReady, this, &CodeEditor::CallSpellChecker); //Nothing was checked before.
+    }
     userInputTimer->setSingleShot(true);
 
     updateLineNumberAreaWidth(0);
@@ -77,15 +90,20 @@ void CodeEditor::contextMenuEvent(QContextMenuEvent *event)
     int pos = cursor.position();
     bool isMisspelled = m_checker->IsMisspelled(this, pos);
     m_suggestions.clear();
+    QAction *addWord = nullptr;
+    QString word;
     if (isMisspelled)
     {
         cursor.select(QTextCursor::WordUnderCursor);
-        QList<QString> corrections = m_checker->Suggest(this, cursor.selectedText());
+        word = cursor.selectedText();
+        QList<QString> corrections = m_checker->Suggest(this, word);
         for (QString s : corrections)
         {
             QAction* action = menu->addAction(s);
             m_suggestions[action] = s;
         }
+        menu->addSeparator();
+        addWord = menu->addAction(tr("Add to Dictionary"));
     }
     menu->addSeparator();
 
@@ -105,10 +123,14 @@ void CodeEditor::contextMenuEvent(QContextMenuEvent *event)
     QAction *chosen = menu->exec(event->globalPos());
     delete menu;
 
-    if (m_suggestions.contains(chosen))
+    if (m_suggestions.contains(chosen) && !isReadOnly())
     {
         cursor.insertText(m_suggestions[chosen]);
     }
+    else if (chosen && chosen == addWord)
+    {
+        m_checker->AddWord(word);
+    }
 }
 
 void CodeEditor::onSelectionChanged()
@@ -120,7 +142,7 @@ void CodeEditor::onSelectionChanged()
 int CodeEditor::lineNumberAreaWidth()
 {
     int digits = 4; //Set the initial margin width.
-    int max = qMax(1, blockCount());
+    qint64 max = qMax<qint64>(1, totalLineCount());
     while (max >= 10000) { //Adjust the width for bigger line counts.
         max /= 10;
         ++digits;
@@ -132,7 +154,7 @@ int CodeEditor::lineNumberAreaWidth()
 
 void CodeEditor::updateLineNumberAreaWidth(int /* newBlockCount */)
 {
-    setViewportMargins(lineNumberAreaWidth(), 0, 0, 0);
+    setViewportMargins(lineNumberAreaWidth(), 0, m_rightMargin, 0);
 }
 
 void CodeEditor::updateLineNumberArea(const QRect &rect, int dy)
@@ -155,6 +177,17 @@ void CodeEditor::resizeEvent(QResizeEvent *e)
 }
 void CodeEditor::highlightCurrentLine()
 {
+    //Runs on every cursor move and selection change, skip it while the highlighted line stays the same (e.g. typing).
+    QTextCursor cursor = textCursor();
+    QTextLayout *layout = cursor.block().layout();
+    QTextLine line = layout ? layout->lineForTextPosition(cursor.positionInBlock()) : QTextLine();
+    const QPair<int, int> current(cursor.blockNumber(), line.isValid() ? line.lineNumber() : 0);
+    if (current == m_highlightedLine && isReadOnly() == m_highlightedReadOnly)
+        return;
+    m_highlightedLine = current;
+    m_highlightedBlocks = blockCount();
+    m_highlightedReadOnly = isReadOnly();
+
     QList<QTextEdit::ExtraSelection> extraSelections;
 
     if (!isReadOnly()) {
@@ -172,6 +205,17 @@ void CodeEditor::highlightCurrentLine()
     SetLineHighlighterSelections(extraSelections);
 }
 
+void CodeEditor::documentContentsChanged(int position, int charsRemoved, int charsAdded)
+{
+    Q_UNUSED(charsRemoved);
+
+    //Typing inside the highlighted line keeps it; lines added or removed, or text reaching past the line (e.g. setPlainText), leave the highlight on a stale block.
+    QTextBlock block = document()->findBlock(position);
+    if (blockCount() != m_highlightedBlocks || block.blockNumber() != m_highlightedLine.first
+        || position + charsAdded >= block.position() + block.length())
+        m_highlightedLine = qMakePair(-1, -1);
+}
+
 void CodeEditor::lineNumberAreaPaintEvent(QPaintEvent *event)
 {
     QPainter painter(lineNumberArea);
@@ -179,6 +223,7 @@ void CodeEditor::lineNumberAreaPaintEvent(QPaintEvent *event)
 
     QTextBlock block = firstVisibleBlock();
     int blockNumber = block.blockNumber();
+    const qint64 lineBase = firstLineNumber();
     int top = (int) blockBoundingGeometry(block).translated(contentOffset()).top();
     int bottom = top + (int) blockBoundingRect(block).height();
 
@@ -193,7 +238,7 @@ void CodeEditor::lineNumberAreaPaintEvent(QPaintEvent *event)
 
     while (block.isValid() && top <= event->rect().bottom()) {
         if (block.isVisible() && bottom >= event->rect().top()) {
-            QString number = QString::number(blockNumber + 1);
+            QString number = QString::number(lineBase + blockNumber + 1);
 
             bool isSelected = hasSelection && (blockNumber >= startLine && blockNumber <= endLine);
 
@@ -221,6 +266,47 @@ void CodeEditor::lineNumberAreaPaintEvent(QPaintEvent *event)
     painter.drawLine(lineNumberArea->width()-1, event->rect().top(), lineNumberArea->width()-1, event->rect().bottom()); //Draw the red margin line.
 }
 
+qint64 CodeEditor::firstLineNumber() const
+{
+    return 0;
+}
+
+qint64 CodeEditor::totalLineCount() const
+{
+    return blockCount();
+}
+
+qint64 CodeEditor::totalLength() const
+{
+    return document()->characterCount() - 1; //Without the trailing paragraph separator.
+}
+
+qint64 CodeEditor::currentLine() const
+{
+    return textCursor().blockNumber();
+}
+
+qint64 CodeEditor::currentOffset() const
+{
+    return textCursor().position();
+}
+
+void CodeEditor::goToLine(qint64 line, int column)
+{
+    //The document keeps its blocks in a tree, finding one by number doesn't walk the lines before it.
+    QTextBlock block = document()->findBlockByNumber(int(qBound<qint64>(0, line, blockCount() - 1)));
+    QTextCursor cursor(block);
+    cursor.setPosition(block.position() + qBound(0, column, block.length() - 1));
+    setTextCursor(cursor);
+}
+
+void CodeEditor::goToOffset(qint64 offset)
+{
+    QTextCursor cursor = textCursor();
+    cursor.setPosition(int(qBound<qint64>(0, offset, totalLength())));
+    setTextCursor(cursor);
+}
+
 void CodeEditor::setZoomLevel(int level)
 {
     QFont currentFont = font();
@@ -272,7 +358,38 @@ void CodeEditor::UpdateUserInputTimer()
 
 void CodeEditor::CallSpellChecker()
 {
-    m_checker->Check(this);
+    if (m_checker)
+        m_checker->Check(this);
+}
+
+QPair<QTextBlock, QTextBlock> CodeEditor::visibleBlockRange() const
+{
+    QTextBlock last = cursorForPosition(QPoint(0, viewport()->height() - 1)).block();
+    return qMakePair(firstVisibleBlock(), last);
+}
+
+void CodeEditor::showEvent(QShowEvent *event)
+{
+    QPlainTextEdit::showEvent(event);
+    CallSpellChecker(); //Tabs aren't checked while hidden.
+}
+
+void CodeEditor::AttachDocument(QTextDocument *document)
+{
+    //Takes ownership of a document built elsewhere (e.g. by FileLoader), it must already use a QPlainTextDocumentLayout.
+    const qreal tabStop = tabStopDistance(); //Kept by the old document's text option, reapplied below.
+
+    document->setParent(this);
+    document->setDefaultFont(font());
+    disconnect(this->document(), &QTextDocument::contentsChange, this, &CodeEditor::documentContentsChanged);
+    setDocument(document);
+    connect(document, &QTextDocument::contentsChange, this, &CodeEditor::documentContentsChanged);
+    setTabStopDistance(tabStop);
+
+    updateLineNumberAreaWidth(0);
+    m_highlightedLine = qMakePair(-1, -1); //New document, the old highlight is gone.
+    highlightCurrentLine();
+    CallSpellChecker();
 }
 
 void CodeEditor::SetSpellcheckerSelections(QList<QTextEdit::ExtraSelection> selections)
@@ -23,6 +23,8 @@
 #include <QWidget>
 #include <QPaintEvent>
 #include <QResizeEvent>
+#include <QShowEvent>
+#include <QTextBlock>
 #include <QTimer>
 #include <QContextMenuEvent>
 #include <QMap>
@@ -46,6 +48,15 @@ public:
     int getZoomLevel();
     void UpdateUserInputTimer();
     void CallSpellChecker();
+    void AttachDocument(QTextDocument *document);
+    QPair<QTextBlock, QTextBlock> visibleBlockRange() const; //First and last block on screen.
+
+    virtual qint64 totalLineCount() const;
+    virtual qint64 totalLength() const; //Characters, or bytes in a viewer.
+    virtual qint64 currentLine() const; //Line of the text cursor, from 0.
+    virtual qint64 currentOffset() const; //Position of the text cursor, in the units of totalLength().
+    virtual void goToLine(qint64 line, int column = 0);
+    virtual void goToOffset(qint64 offset);
 
     void SetSpellcheckerSelections(QList<QTextEdit::ExtraSelection> selections);
     void SetLineHighlighterSelections(QList<QTextEdit::ExtraSelection> selections);
@@ -54,12 +65,18 @@ public:
 
 protected:
     void resizeEvent(QResizeEvent *event) override;
+    void showEvent(QShowEvent *event) override;
     void keyPressEvent(QKeyEvent *event) override;
     void contextMenuEvent(QContextMenuEvent *event) override;
+    virtual qint64 firstLineNumber() const; //Line number of the first block, non-zero when only part of a file is shown.
+    int m_rightMargin = 0; //Room reserved right of the viewport for custom widgets.
 
-private slots:
+protected slots:
     void updateLineNumberAreaWidth(int newBlockCount);
+
+private slots:
     void highlightCurrentLine();
+    void documentContentsChanged(int position, int charsRemoved, int charsAdded);
     void updateLineNumberArea(const QRect &, int);
 
 private:
@@ -74,6 +91,10 @@ private:
     QList<QTextEdit::ExtraSelection> m_lineHighlighterSelections;
     QList<QTextEdit::ExtraSelection> m_findAndReplaceSelections;
 
+    QPair<int, int> m_highlightedLine = qMakePair(-1, -1); //Block and layout line of the current line highlight.
+    int m_highlightedBlocks = 0; //Block count when it was set, edits adding or removing lines redo it.
+    bool m_highlightedReadOnly = false;
+
     QWidget *lineNumberArea;
     int CurrentZoomLevel = 0;
     void onSelectionChanged();
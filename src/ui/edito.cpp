@@ -61,6 +61,18 @@ void Edito::on_Open_clicked()
     else QMessageBox::critical(this, "Error", "Failed to open from a file.");
 }
 
+void Edito::openFiles(const QStringList &targets)
+{
+    this->close();
+    Editor *editor = new Editor(checker);
+    editor->setAttribute(Qt::WA_DeleteOnClose);
+    editor->show();
+    editor->raise();
+    editor->activateWindow();
+    for (const QString &target : targets)
+        editor->OpenFile(target);
+}
+
 void Edito::on_createNew_clicked()
 {
     this->close();
@@ -34,6 +34,7 @@ class Edito : public QMainWindow
 
 public:
     Edito(QWidget *parent = nullptr);
+    void openFiles(const QStringList &targets); //Paths or "path:line[:column]", straight into an editor window.
     ~Edito();
 
 private slots:
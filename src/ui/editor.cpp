@@ -18,6 +18,11 @@
 
 #include "src/ui/editor.h"
 #include "src/ui/edito.h"
+#include "src/ui/largefileviewer.h"
+#include "src/core/documentstats.h"
+#include "src/core/documentwriter.h"
+#include "src/core/filesaver.h"
+#include "src/core/updatescheduler.h"
 #include "src/dialogs/gotodialog.h"
 #include "src/dialogs/preferencesdialog.h"
 #include "qtextobject.h"
@@ -49,6 +54,13 @@
 #include <QStringEncoder>
 #include <QTimer>
 #include <QPushButton>
+#include <QThread>
+#include <QLocale>
+#include <QTabBar>
+#include <QProgressBar>
+#include <QToolButton>
+#include <QHBoxLayout>
+#include <QPointer>
 #include <windows.h>
 #include <shellapi.h>
 
@@ -72,6 +84,15 @@ Editor::Editor(SpellChecker *check, QWidget *parent)
     ui->editorTabs->removeTab(0); //Removing the default "Tab 1".
     setAcceptDrops(true);
 
+    m_updates = new UpdateScheduler(this); //Status bar, menus and actions are refreshed at most once per frame.
+    m_updates->setHandler(StatusUpdate, [this]() { UpdateStatusBar(); });
+    m_updates->setHandler(UndoRedoUpdate, [this]() { UpdateUndoRedo(); });
+    m_updates->setHandler(MenuUpdate, [this]() { UpdateMenus(); });
+    m_updates->setHandler(SelectionUpdate, [this]() {
+        CodeEditor *editor = currentEditor();
+        selectionTrack(editor && editor->textCursor().hasSelection());
+    });
+
     m_settings = new QSettings("Yovsky", "Edito");
     if (!m_settings->contains("SE"))
     {
@@ -105,72 +126,74 @@ Editor::Editor(SpellChecker *check, QWidget *parent)
     connect(ui->editorTabs, &QTabWidget::currentChanged, this, [this](int index) //Connecting when swiching tabs.
     {
         Q_UNUSED(index);
-        CodeEditor *editor = currentEditor();
-        bool hasEditor = (editor != nullptr);
-        for (QAction *action : encMenu->actions())
+        m_updates->invalidate(MenuUpdate | StatusUpdate | UndoRedoUpdate | SelectionUpdate);
+    });
+
+    m_updates->invalidate(StatusUpdate);
+    AutoSaveTimer();
+
+    for (QAction *action : encMenu->actions())
+    {
+        action->setEnabled(false);
+        action->setChecked(false);
+    }
+}
+
+void Editor::UpdateMenus()
+{
+    CodeEditor *editor = currentEditor();
+    bool hasEditor = (editor != nullptr);
+    for (QAction *action : encMenu->actions())
+    {
+        action->setEnabled(hasEditor);
+        if (!hasEditor)
         {
-            action->setEnabled(hasEditor);
-            if (!hasEditor)
-            {
-                action->setChecked(false);
-            }
+            action->setChecked(false);
         }
+    }
 
-        if (editor && currentEncodings.contains(editor))
+    if (editor && currentEncodings.contains(editor))
+    {
+        QString encoding = currentEncodings.value(editor);
+        for (QAction *action : encMenu->actions())
         {
-            QString encoding = currentEncodings.value(editor);
-            for (QAction *action : encMenu->actions())
+            if (action->data().toString() == encoding)
             {
-                if (action->data().toString() == encoding)
-                {
-                    action->setChecked(true);
-                    break;
-                }
+                action->setChecked(true);
+                break;
             }
         }
+    }
 
-        if (editor && currentEncodings.contains(editor))
+    if (editor && currentEncodings.contains(editor))
+    {
+        if (currentEncodings.value(editor) == "Windows (CR LF)")
         {
-            if (currentEncodings.value(editor) == "Windows (CR LF)")
-            {
-                ui->actionWindows_CR_LF->setEnabled(false);
-                ui->actionUnix_LF->setEnabled(true);
-                ui->actionMacintosh_RC->setEnabled(true);
-            }
-            else if (currentEncodings.value(editor) == "Unix (LF)")
-            {
-                ui->actionUnix_LF->setEnabled(false);
-                ui->actionWindows_CR_LF->setEnabled(true);
-                ui->actionMacintosh_RC->setEnabled(true);
-            }
-            else if (currentEncodings.value(editor) == "Unix (LF)")
-            {
-                ui->actionMacintosh_RC->setEnabled(false);
-                ui->actionUnix_LF->setEnabled(true);
-                ui->actionWindows_CR_LF->setEnabled(true);
-            }
+            ui->actionWindows_CR_LF->setEnabled(false);
+            ui->actionUnix_LF->setEnabled(true);
+            ui->actionMacintosh_RC->setEnabled(true);
         }
-
-        if (!filePaths.contains(editor) || filePaths.value(editor).isEmpty())
+        else if (currentEncodings.value(editor) == "Unix (LF)")
         {
-            ui->actionFile_Explorer->setDisabled(true);
+            ui->actionUnix_LF->setEnabled(false);
+            ui->actionWindows_CR_LF->setEnabled(true);
+            ui->actionMacintosh_RC->setEnabled(true);
         }
-        else
+        else if (currentEncodings.value(editor) == "Unix (LF)")
         {
-            ui->actionFile_Explorer->setEnabled(true);
+            ui->actionMacintosh_RC->setEnabled(false);
+            ui->actionUnix_LF->setEnabled(true);
+            ui->actionWindows_CR_LF->setEnabled(true);
         }
+    }
 
-        this->UpdateStatusBar();
-        this->UpdateUndoRedo();
-    });
-
-    UpdateStatusBar();
-    AutoSaveTimer();
-
-    for (QAction *action : encMenu->actions())
+    if (!filePaths.contains(editor) || filePaths.value(editor).isEmpty())
     {
-        action->setEnabled(false);
-        action->setChecked(false);
+        ui->actionFile_Explorer->setDisabled(true);
+    }
+    else
+    {
+        ui->actionFile_Explorer->setEnabled(true);
     }
 }
 
@@ -276,24 +299,43 @@ void Editor::UpdateStatusBar()
     }
 
     QTextCursor cursor = editor->textCursor();
-    if (posStatus) //For position.
+    if (LargeFileViewer *viewer = qobject_cast<LargeFileViewer*>(editor)) //Only part of the file is in the document.
     {
-        posStatus->setText("Line " + QString::number(cursor.blockNumber() + 1) //Line position.
-                           + ", Col " + QString::number(cursor.positionInBlock() + 1) //Column position.
-                           + ", Pos " + QString::number(cursor.position() + 1)); //Character position.
+        MappedFile *file = viewer->mappedFile();
+        if (posStatus)
+            posStatus->setText("Line " + QString::number(viewer->currentLine() + 1)
+                               + ", Col " + QString::number(cursor.positionInBlock() + 1)
+                               + ", Offset " + QString::number(viewer->currentOffset())); //Byte offset of the line.
+        if (sizeStatus)
+            sizeStatus->setText("Size " + QLocale().formattedDataSize(file->size())
+                                + ", Lines " + QString::number(file->lineCount())
+                                + (file->isIndexComplete() ? "" : "+")); //Still indexing.
     }
-
-    if (sizeStatus) //For size.
+    else
     {
-        QString text = editor->toPlainText();
-        QStringList words = text.split(QRegularExpression("\\s+"), Qt::SkipEmptyParts);
+        DocumentStats *stats = DocumentStats::of(editor->document()); //Kept up to date as the document changes.
+
+        if (posStatus) //For position.
+        {
+            QString position = "Line " + QString::number(cursor.blockNumber() + 1) //Line position.
+                               + ", Col " + QString::number(cursor.positionInBlock() + 1) //Column position.
+                               + ", Pos " + QString::number(cursor.position() + 1); //Character position.
+            if (cursor.hasSelection())
+            {
+                TextStats selection = stats->stats(cursor.selectionStart(), cursor.selectionEnd());
+                position += ", Sel " + QString::number(selection.characters) //Selected characters.
+                            + " (" + QString::number(selection.words) + " words)"; //Selected words.
+            }
+            posStatus->setText(position);
+        }
 
-        int chCount = text.length();
-        int lnCount = editor->document()->blockCount();
-        int wCount = words.size();
-        sizeStatus->setText("Size " + QString::number(chCount) //Character count.
-                            + ", Words " + QString::number(wCount) //Word count.
-                            + ", Lines " + QString::number(lnCount)); //Line count.
+        if (sizeStatus) //For size.
+        {
+            TextStats total = stats->stats();
+            sizeStatus->setText("Size " + QString::number(total.characters) //Character count.
+                                + ", Words " + QString::number(total.words) //Word count.
+                                + ", Lines " + QString::number(total.lines)); //Line count.
+        }
     }
     if (zoomStatus)
     {
@@ -417,8 +459,22 @@ void Editor::resetTabState(CodeEditor *editor,bool modified)
     }
 }
 
-void Editor::OpenFile(const QString &FilePath)
+void Editor::OpenFile(const QString &OpenTarget)
 {
+    QString FilePath = OpenTarget;
+    qint64 goLine = -1; //Line to show once loaded, -1 for none.
+    int goColumn = 0;
+
+    //"file:line[:column]" (e.g. compiler output), when no file has that literal name.
+    static const QRegularExpression lineTarget("^(.+?):(\\d+)(?::(\\d+))?$");
+    QRegularExpressionMatch match = lineTarget.match(OpenTarget);
+    if (!QFileInfo::exists(OpenTarget) && match.hasMatch() && QFileInfo::exists(match.captured(1)))
+    {
+        FilePath = match.captured(1);
+        goLine = match.captured(2).toLongLong() - 1;
+        goColumn = match.captured(3).isEmpty() ? 0 : match.captured(3).toInt() - 1;
+    }
+
     QFile file(FilePath);
 
     if(!file.open(QIODevice::ReadOnly)) //File opening.
@@ -426,102 +482,227 @@ void Editor::OpenFile(const QString &FilePath)
         QMessageBox::critical(this, "Error", "Failed to open file " + FilePath); //Error handling.
         return;
     }
+    file.close(); //The loader reopens it on its own thread.
+
+    qint64 viewerThreshold = m_settings->value("Viewer Threshold", 256).toLongLong() * 1024 * 1024; //In MB.
+    if (viewerThreshold > 0 && QFileInfo(FilePath).size() >= viewerThreshold && OpenInViewer(FilePath))
+    {
+        if (goLine >= 0)
+            currentEditor()->goToLine(goLine, goColumn); //The viewer waits for the index to reach it.
+        return; //Too big to decode as a whole, shown through the read-only viewer.
+    }
 
     CodeEditor *editor = new CodeEditor(nullptr, m_checker);
 
-    //Read content.
-    QByteArray data = file.readAll();
-    file.close();
+    isSaved.insert(editor, true);
+    SetupEditor(editor);
 
-    qDebug() << "opened size" + QString::number(data.size());
+    editor->setReadOnly(true); //Nothing to edit until the document arrives.
+    editor->setPlaceholderText(tr("Loading %1...").arg(QFileInfo(file).fileName()));
+    editor->setLineWrapMode(wordWrap? QPlainTextEdit::WidgetWidth : QPlainTextEdit::NoWrap); //Word Wrap state.
 
-    int CRLF = 0;
-    int CR = 0;
-    int LF = 0;
+    QIcon icon(":/icons/saved"); //Setting the icon.
 
-    for (int i = 0; i < data.size(); i++)
-    {
-        if (data[i] == '\r')
+    tabBaseNames.insert(editor, QFileInfo(file).fileName()); //Registering the tab name for later use.
+    filePaths.insert(editor,FilePath); //Registering the file path for later use.
+    lineEndings.insert(editor, "Unknown");
+    if (goLine >= 0)
+        pendingGoTo.insert(editor, qMakePair(goLine, goColumn)); //Applied in FileLoaded.
+
+    int tabIndex = ui->editorTabs->addTab(editor, icon,QFileInfo(file).fileName()); //Set tab parameters.
+    ui->editorTabs->setCurrentWidget(editor);
+
+    editor->setZoomLevel(zoomLevel);
+    RestoreZoom(zoomLevel); //Set zoom.
+
+    //Progress indicator and cancel button shown in the tab while loading.
+    QWidget *loadWidget = new QWidget;
+    QHBoxLayout *loadLayout = new QHBoxLayout(loadWidget);
+    loadLayout->setContentsMargins(0, 0, 0, 0);
+    loadLayout->setSpacing(2);
+    QProgressBar *loadProgress = new QProgressBar(loadWidget);
+    loadProgress->setRange(0, 100);
+    loadProgress->setTextVisible(false);
+    loadProgress->setFixedSize(48, 10);
+    QToolButton *loadCancel = new QToolButton(loadWidget);
+    loadCancel->setIcon(QIcon(":/icons/close.png"));
+    loadCancel->setToolTip(tr("Cancel loading"));
+    loadCancel->setAutoRaise(true);
+    loadCancel->setFixedSize(16, 16);
+    loadLayout->addWidget(loadProgress);
+    loadLayout->addWidget(loadCancel);
+    ui->editorTabs->tabBar()->setTabButton(tabIndex, QTabBar::LeftSide, loadWidget);
+
+    //Read, detect, decode and lay out on a worker thread.
+    QThread *thread = new QThread(this);
+    FileLoader *loader = new FileLoader(FilePath, QThread::currentThread());
+    loader->moveToThread(thread);
+    fileLoaders.insert(editor, loader);
+
+    connect(thread, &QThread::started, loader, &FileLoader::run);
+    connect(loader, &FileLoader::finished, thread, &QThread::quit);
+    connect(thread, &QThread::finished, loader, &QObject::deleteLater);
+    connect(thread, &QThread::finished, thread, &QObject::deleteLater);
+
+    connect(loader, &FileLoader::progress, loadProgress, [loadProgress, FilePath](int percent, const QString &stage) {
+        loadProgress->setValue(percent);
+        loadProgress->setToolTip(stage + " " + QFileInfo(FilePath).fileName());
+    });
+    connect(loadCancel, &QToolButton::clicked, this, [this, editor]() {
+        CancelLoad(editor);
+    });
+    connect(loader, &FileLoader::loaded, this, [this, editor, loader](const FileLoadResult &result) {
+        if (fileLoaders.value(editor) != loader) //Tab closed or canceled meanwhile.
         {
-            if (i+1 < data.size() && data[i+1] == '\n')
-            {
-                CRLF++;
-                i++;
-            }
-            else
-                CR++;
+            delete result.document;
+            return;
         }
-        else if (data[i] == '\n')
-            LF++;
-    }
-
-    if (CRLF > CR && CRLF > LF)
-        lineEndings.insert(editor, "Windows (CR LF)");
-    else if (CR > CRLF && CR > LF)
-        lineEndings.insert(editor, "Macintosh (CR)");
-    else if (LF > CRLF && LF > CR)
-        lineEndings.insert(editor, "Unix (LF)");
-    else if (CR == 0 && LF == 0 && CRLF == 0)
-        lineEndings.insert(editor, "Unknown");
-    else
-        lineEndings.insert(editor, "Mixed");
+        FileLoaded(editor, result);
+    });
+    connect(loader, &FileLoader::failed, this, [this, editor, loader](const QString &error) {
+        if (fileLoaders.value(editor) != loader) return;
+        QMessageBox::critical(this, "Error", error); //Error handling.
+        CancelLoad(editor);
+    });
+
+    thread->start();
+
+    m_updates->invalidate(StatusUpdate); //Status update.
+}
 
-    //Detect Encoding.
-    encdetector::encodingResult result = encdetector::detectEncoding(data);
+bool Editor::OpenInViewer(const QString &FilePath)
+{
+    MappedFile *file = new MappedFile(FilePath);
+    if (!file->open())
+    {
+        qDebug() << "mapping failed" << file->errorString();
+        delete file;
+        return false; //Fall back to the regular loader.
+    }
+
+    //Detect from windows spread over the whole file, the viewer only handles encodings where LF is a single byte.
+    encdetector::encodingResult result = encdetector::detectFile(FilePath);
+    if (!MappedFile::supportsEncoding(result.converterEnc))
+    {
+        delete file;
+        return false;
+    }
+    file->setEncoding(result.converterEnc);
 
-    QStringDecoder decoder = QStringDecoder(result.converterEnc);
-    QString content = decoder.decode(data);
+    LargeFileViewer *viewer = new LargeFileViewer(file, nullptr, m_checker);
+
+    isSaved.insert(viewer, true);
+    SetupEditor(viewer);
+    connect(file, &MappedFile::indexProgress, this, [this]() { m_updates->invalidate(StatusUpdate); }); //Line count grows while indexing.
+    connect(file, &MappedFile::indexFinished, this, [this, viewer, file]() {
+        lineEndings.insert(viewer, file->lineEnding()); //Counted by the indexing pass.
+        m_updates->invalidate(StatusUpdate);
+    });
 
-    if (decoder.hasError())
+    QString fileName = QFileInfo(FilePath).fileName();
+    tabBaseNames.insert(viewer, fileName); //Registering the tab name for later use.
+    filePaths.insert(viewer, FilePath); //Registering the file path for later use.
+    currentEncodings.insert(viewer, result.encoding);
+    hasBOM.insert(viewer, result.hasBOM);
+    lineEndings.insert(viewer, "Unknown"); //Filled in once the index is complete.
+
+    int tabIndex = ui->editorTabs->addTab(viewer, QIcon(":/icons/saved"), fileName); //Set tab parameters.
+    ui->editorTabs->setTabToolTip(tabIndex, tr("%1 (read-only viewer)").arg(FilePath));
+    ui->editorTabs->setCurrentWidget(viewer);
+
+    viewer->setZoomLevel(zoomLevel);
+    RestoreZoom(zoomLevel); //Set zoom.
+
+    resetTabState(viewer, false);
+    m_updates->invalidate(StatusUpdate); //Status update.
+    return true;
+}
+
+void Editor::FileLoaded(CodeEditor *editor, const FileLoadResult &result)
+{
+    fileLoaders.remove(editor);
+
+    int tabIndex = ui->editorTabs->indexOf(editor);
+    if (tabIndex != -1)
     {
+        QWidget *loadWidget = ui->editorTabs->tabBar()->tabButton(tabIndex, QTabBar::LeftSide);
+        ui->editorTabs->tabBar()->setTabButton(tabIndex, QTabBar::LeftSide, nullptr);
+        if (loadWidget) loadWidget->deleteLater();
+    }
+
+    if (result.usedFallback)
         QMessageBox::warning(this, "Warning", "Detected encoding may be incorrect, Using fallback encoding.");
-        QStringDecoder fallBackDec = QStringDecoder(QStringConverter::Encoding::Utf8);
-        content = fallBackDec.decode(data);
-        if (fallBackDec.hasError())
+
+    editor->AttachDocument(result.document); //Passing the file content to the text editor.
+    editor->setPlaceholderText(QString());
+    editor->setReadOnly(isReadOnly); //Read-Only state.
+    editor->setLineWrapMode(wordWrap? QPlainTextEdit::WidgetWidth : QPlainTextEdit::NoWrap); //Word Wrap state.
+
+    lineEndings.insert(editor, result.lineEnding);
+    currentEncodings.insert(editor, result.encoding);
+    hasBOM.insert(editor, result.hasBOM);
+
+    resetTabState(editor, false);
+    editor->document()->setModified(false);
+
+    if (pendingGoTo.contains(editor))
+    {
+        QPair<qint64, int> target = pendingGoTo.take(editor);
+        editor->goToLine(target.first, target.second);
+    }
+
+    if (editor == currentEditor())
+    {
+        for (QAction *action : encMenu->actions())
         {
-            QStringDecoder latin1Dec = QStringDecoder(QStringConverter::Encoding::Latin1);
-            content = latin1Dec.decode(data);
+            if (action->data().toString() == result.encoding)
+            {
+                action->setChecked(true);
+                break;
+            }
         }
     }
 
+    editor->UpdateUserInputTimer(); //Schedule the spell check for the new content.
+    m_updates->invalidate(StatusUpdate); //Status update.
+}
 
-    isSaved.insert(editor, true);
+void Editor::CancelLoad(CodeEditor *editor)
+{
+    FileLoader *loader = fileLoaders.take(editor);
+    if (!loader) return;
+    loader->cancel(); //The worker stops at its next checkpoint and cleans itself up.
+
+    int index = ui->editorTabs->indexOf(editor);
+    if (index != -1)
+        ui->editorTabs->removeTab(index);
+
+    tabBaseNames.remove(editor); //Remove tab data.
+    filePaths.remove(editor);
+    currentEncodings.remove(editor);
+    lineEndings.remove(editor);
+    hasBOM.remove(editor);
+    pendingGoTo.remove(editor); //Would otherwise be applied to whatever tab gets this address next.
+    isSaved.remove(editor);
+    editor->deleteLater();
+}
 
+void Editor::SetupEditor(CodeEditor *editor)
+{
     editor->editorActions(ui->actionCut, ui->actionCopy, ui->actionPaste, ui->actionSelect_All, ui->actionUPPERCASE, ui->actionLowercase, ui->actionSearch_on_Web); //Pass actions for context menu.
 
-    connect(editor, &QPlainTextEdit::cursorPositionChanged, this, &Editor::UpdateStatusBar); //Connecting signals for Status.
-    connect(editor, &QPlainTextEdit::textChanged, this, &Editor::UpdateStatusBar);
+    connect(editor, &QPlainTextEdit::cursorPositionChanged, this, [this]() { m_updates->invalidate(StatusUpdate); }); //Connecting signals for Status.
+    connect(editor, &QPlainTextEdit::textChanged, this, [this]() { m_updates->invalidate(StatusUpdate); });
     connect(editor, &QPlainTextEdit::modificationChanged, this, &Editor::FileEdited); //Connecting signal for Unsaved indicator.
-    connect(editor, &QPlainTextEdit::undoAvailable, this, &Editor::UndoApperance);
-    connect(editor, &QPlainTextEdit::redoAvailable, this, &Editor::RedoApperance);
+    connect(editor, &QPlainTextEdit::undoAvailable, this, [this]() { m_updates->invalidate(UndoRedoUpdate); });
+    connect(editor, &QPlainTextEdit::redoAvailable, this, [this]() { m_updates->invalidate(UndoRedoUpdate); });
     connect(editor, &CodeEditor::zoomInRequested, this, &Editor::zoomIn); //Connecting signals for zoom feature.
     connect(editor, &CodeEditor::zoomOutRequested, this, &Editor::zoomOut);
     connect(editor, &CodeEditor::cutRequested, this, &Editor::on_actionCut_triggered); //Connecting signal for shortcuts.
     connect(editor, &CodeEditor::copyRequested, this, &Editor::copySelection);
     connect(editor, &CodeEditor::pasteRequested, this, &Editor::on_actionPaste_triggered);
     connect(editor, &CodeEditor::selectAllRequested, this, &Editor::on_actionSelect_All_triggered);
-    connect(editor, &CodeEditor::selectionStateChanged, this, &Editor::selectionTrack); //Connecting signal for selection track.
-
-    editor->setPlainText(content); //Passing the file content to the text editor.
-    editor->setReadOnly(isReadOnly); //Read-Only state.
-    editor->setLineWrapMode(wordWrap? QPlainTextEdit::WidgetWidth : QPlainTextEdit::NoWrap); //Word Wrap state.
-
-    QIcon icon(":/icons/saved"); //Setting the icon.
-
-    tabBaseNames.insert(editor, QFileInfo(file).fileName()); //Registering the tab name for later use.
-    filePaths.insert(editor,FilePath); //Registering the file path for later use.
-    currentEncodings.insert(editor, result.encoding);
-
-    ui->editorTabs->addTab(editor, icon,QFileInfo(file).fileName()); //Set tab parameters.
-    ui->editorTabs->setCurrentWidget(editor);
-
-    editor->setZoomLevel(zoomLevel);
-    RestoreZoom(zoomLevel); //Set zoom.
-
-    resetTabState(editor, false);
-    editor->document()->setModified(false);
-
-    UpdateStatusBar(); //Status update.
+    connect(editor, &CodeEditor::selectionStateChanged, this, [this]() { m_updates->invalidate(SelectionUpdate); }); //Connecting signal for selection track.
 }
 
 void Editor::NewFile()
@@ -540,22 +721,9 @@ void Editor::NewFile()
         }
     }
 
-    editor->editorActions(ui->actionCut, ui->actionCopy, ui->actionPaste, ui->actionSelect_All, ui->actionUPPERCASE, ui->actionLowercase, ui->actionSearch_on_Web); //Pass actions for context menu.
+    SetupEditor(editor);
     ui->actionUTF_8->setChecked(true);
 
-    connect(editor, &QPlainTextEdit::cursorPositionChanged, this, &Editor::UpdateStatusBar); //Connecting signals for Status.
-    connect(editor, &QPlainTextEdit::textChanged, this, &Editor::UpdateStatusBar);
-    connect(editor, &QPlainTextEdit::modificationChanged, this, &Editor::FileEdited); //Connecting signal for Unsaved indicator.
-    connect(editor, &QPlainTextEdit::undoAvailable, this, &Editor::UndoApperance);
-    connect(editor, &QPlainTextEdit::redoAvailable, this, &Editor::RedoApperance);
-    connect(editor, &CodeEditor::zoomInRequested, this, &Editor::zoomIn); //Connecting signals for zoom feature.
-    connect(editor, &CodeEditor::zoomOutRequested, this, &Editor::zoomOut);
-    connect(editor, &CodeEditor::cutRequested, this, &Editor::on_actionCut_triggered); //Connecting signal for shortcuts.
-    connect(editor, &CodeEditor::copyRequested, this, &Editor::copySelection);
-    connect(editor, &CodeEditor::pasteRequested, this, &Editor::on_actionPaste_triggered);
-    connect(editor, &CodeEditor::selectAllRequested, this, &Editor::on_actionSelect_All_triggered);
-    connect(editor, &CodeEditor::selectionStateChanged, this, &Editor::selectionTrack); //Connecting signal for selection track.
-
     QIcon icon(":/icons/saved.png");
 
     if(openedTabs == 0)
@@ -586,7 +754,7 @@ void Editor::NewFile()
     resetTabState(editor, false);
 
 
-    UpdateStatusBar(); //Status update.
+    m_updates->invalidate(StatusUpdate); //Status update.
 }
 
 void Editor::CloseTab(int index)
@@ -596,6 +764,12 @@ void Editor::CloseTab(int index)
     CodeEditor *editor = qobject_cast<CodeEditor*>(ui->editorTabs->widget(index));
     if (!editor) return; //Safety.
 
+    if (fileLoaders.contains(editor)) //Still loading, nothing to save.
+    {
+        CancelLoad(editor);
+        return;
+    }
+
     bool should_close = true;
 
     if (editor->document()->isModified()) //File is not saved.
@@ -609,8 +783,8 @@ void Editor::CloseTab(int index)
 
         if (reply == QMessageBox::Save)
         {
-            if(!Save(editor))
-                should_close = false; //Pass to save and handle failure.
+            if(!Save(editor, true))
+                should_close = false; //Pass to save and handle failure, waiting since the tab is going away.
         }
         else if (reply == QMessageBox::Cancel)
             should_close = false; //User canceled.
@@ -634,6 +808,10 @@ void Editor::CloseTab(int index)
         ui->editorTabs->removeTab(index); //Close the tab.
         tabBaseNames.remove(editor); //Remove tab data.
         filePaths.remove(editor);
+        pendingGoTo.remove(editor);
+        hasBOM.remove(editor);
+        saveThreads.remove(editor); //A running save still finishes, it only works on its snapshot.
+        pendingSaves.remove(editor);
         currentEncodings.remove(editor);
         isSaved.remove(editor);
         delete editor;
@@ -650,8 +828,13 @@ void Editor::AutoSave()
     }
 }
 
-bool Editor::SaveAs(CodeEditor* editor)
+bool Editor::SaveAs(CodeEditor* editor, bool wait)
 {
+    if (fileLoaders.contains(editor))
+        return false; //Content not loaded yet.
+    if (qobject_cast<LargeFileViewer*>(editor))
+        return false; //The viewer only holds the visible lines.
+
     QString Deflocation = QStandardPaths::writableLocation(QStandardPaths::DocumentsLocation);
     if (Deflocation.isEmpty()) Deflocation = QStandardPaths::writableLocation(QStandardPaths::HomeLocation);
     QString filePath = QFileDialog::getSaveFileName(this, tr("Save As..."), Deflocation, tr("Text Files (*.txt)")); //Obtaining new file path.
@@ -665,54 +848,19 @@ bool Editor::SaveAs(CodeEditor* editor)
     int tabIndex = ui->editorTabs->indexOf(editor);
     ui->editorTabs->setTabText(tabIndex, QFileInfo(filePath).fileName()); //Changes tab title to new file name.
 
-    QFile file(filePath);
-    if (file.open(QIODevice::WriteOnly)) //File opening.
-    {
-        QStringConverter::Encoding enc = textToEnc(currentEncodings.value(editor));
-
-        QString text = editor->toPlainText();
-        qDebug() << text;
-
-        if (lineEndings.value(editor) == "Windows (CR LF)" || lineEndings.value(editor) == "Unknown" || lineEndings.value(editor) == "Mixed")
-        {
-            text.replace("\r\n", "\n").replace("\r", "\n");
-            text.replace("\n", "\r\n");
-            lineEndings.insert(editor, "Windows (CR LF)");
-        }
-        else if (lineEndings.value(editor) == "Unix (LF)")
-        {
-            text.replace("\r\n", "\n").replace("\r", "\n");
-        }
-        else if (lineEndings.value(editor) == "Macintosh (CR)")
-        {
-            text.replace("\r\n", "\r").replace("\n", "\r");
-        }
-
-        QStringEncoder encoder(enc);
-        QByteArray data = encoder.encode(text);
-        if (encoder.hasError())
-        {
-            QStringEncoder fallBackEnc = QStringEncoder(QStringConverter::Encoding::Utf8);
-            data = fallBackEnc.encode(text);
-            if (fallBackEnc.hasError())
-                return false;
-        }
-
-        file.write(data);
-        file.close();
-
-        editor->document()->setModified(false); //Set file as saved.
-        resetTabState(editor, false);
-        return true; //File saved.
-    }
-    return false; //Save failed.
+    return WriteFile(editor, filePath, wait); //Tab state is updated once the file is written.
 }
 
-bool Editor::Save(CodeEditor* editor)
+bool Editor::Save(CodeEditor* editor, bool wait)
 {
+    if (fileLoaders.contains(editor))
+        return false; //Content not loaded yet, writing now would truncate the file.
+    if (qobject_cast<LargeFileViewer*>(editor))
+        return false; //Read-only viewer, nothing to write.
+
     if(filePaths.value(editor).isEmpty()) //If the file does not exist (no path).
     {
-        if(!SaveAs(editor))
+        if(!SaveAs(editor, wait))
         {
             QMessageBox::critical(this, "Error", "Failed to save file."); //Error handling.
             return false; //SaveAs failed.
@@ -721,44 +869,9 @@ bool Editor::Save(CodeEditor* editor)
     }
     else
     {
-        QFile file(filePaths.value(editor)); //Pass the file path.
-        if (file.open(QIODevice::WriteOnly))
+        if (WriteFile(editor, filePaths.value(editor), wait)) //Pass the file path.
         {
-            QStringConverter::Encoding enc = textToEnc(currentEncodings.value(editor));
-
-            QString text = editor->toPlainText();
-
-            if (lineEndings.value(editor) == "Windows (CR LF)" || lineEndings.value(editor) == "Unknown" || lineEndings.value(editor) == "Mixed")
-            {
-                text.replace("\r\n", "\n").replace("\r", "\n");
-                text.replace("\n", "\r\n");
-                lineEndings.insert(editor, "Windows (CR LF)");
-            }
-            else if (lineEndings.value(editor) == "Unix (LF)")
-            {
-                text.replace("\r\n", "\n").replace("\r", "\n");
-            }
-            else if (lineEndings.value(editor) == "Macintosh (CR)")
-            {
-                text.replace("\r\n", "\r").replace("\n", "\r");
-            }
-
-            QStringEncoder encoder(enc);
-            QByteArray data = encoder.encode(text);
-            if(encoder.hasError())
-            {
-                QStringEncoder fallBackEnc = QStringEncoder(QStringConverter::Encoding::Utf8);
-                data = fallBackEnc.encode(text);
-                if (fallBackEnc.hasError())
-                    return false;
-            }
-
-            file.write(data);
-            file.close();
-
-            editor->document()->setModified(false); //Set file as saved.
-            resetTabState(editor, false);
-            return true; //Save sucessful.
+            return true; //Save sucessful (or started).
         }
         else
         {
@@ -768,6 +881,77 @@ bool Editor::Save(CodeEditor* editor)
     }
 }
 
+bool Editor::WriteFile(CodeEditor *editor, const QString &filePath, bool wait)
+{
+    if (QThread *running = saveThreads.value(editor))
+    {
+        if (!wait)
+        {
+            pendingSaves.insert(editor, filePath); //Written again once the running save is done, never two at once.
+            return true;
+        }
+        running->quit(); //Keep the order of writes to the file.
+        running->wait();
+    }
+
+    QString ending = lineEndings.value(editor);
+    if (ending == "Unknown" || ending == "Mixed")
+    {
+        ending = "Windows (CR LF)"; //Mixed files are normalized.
+        lineEndings.insert(editor, ending);
+    }
+
+    //The snapshot is the only work done here, encoding and disk I/O happen in the saver.
+    FileSaver *saver = new FileSaver(filePath, DocumentWriter::snapshot(editor->document()),
+                                     textToEnc(currentEncodings.value(editor)), DocumentWriter::lineBreakFor(ending),
+                                     hasBOM.value(editor));
+    const int revision = editor->document()->revision();
+    QPointer<CodeEditor> target(editor);
+
+    auto markSaved = [this, target, revision]() {
+        if (target && target->document()->revision() == revision) //Edits made during the save are still unsaved.
+        {
+            target->document()->setModified(false); //Set file as saved.
+            resetTabState(target, false);
+        }
+    };
+
+    if (wait) //The caller needs the outcome right away.
+    {
+        bool ok = false;
+        connect(saver, &FileSaver::saved, this, [&ok]() { ok = true; });
+        saver->run();
+        delete saver;
+        if (ok)
+            markSaved();
+        return ok;
+    }
+
+    QThread *thread = new QThread(this);
+    saver->moveToThread(thread);
+    saveThreads.insert(editor, thread);
+
+    connect(thread, &QThread::started, saver, &FileSaver::run);
+    connect(saver, &FileSaver::finished, thread, &QThread::quit);
+    connect(thread, &QThread::finished, saver, &QObject::deleteLater);
+    connect(thread, &QThread::finished, thread, &QObject::deleteLater);
+
+    connect(saver, &FileSaver::saved, this, markSaved);
+    connect(saver, &FileSaver::failed, this, [this, filePath](const QString &error) {
+        QMessageBox::critical(this, "Error", "Failed to save file " + filePath + "\n" + error); //Error handling.
+    });
+    connect(saver, &FileSaver::finished, this, [this, editor, thread]() {
+        if (saveThreads.value(editor) != thread)
+            return; //Tab closed meanwhile.
+        saveThreads.remove(editor);
+        if (pendingSaves.contains(editor))
+            WriteFile(editor, pendingSaves.take(editor), false);
+    });
+
+    thread->start();
+    return true;
+}
+
 void Editor::on_actionOpen_triggered()
 {
     QString DefLocation =  QStandardPaths::writableLocation(QStandardPaths::DocumentsLocation); //Get the Documents folder.
@@ -813,6 +997,15 @@ CodeEditor* Editor::currentEditor() const
     return qobject_cast<CodeEditor*>(ui->editorTabs->currentWidget());
 }
 
+CodeEditor* Editor::editableEditor() const
+{
+    //QTextCursor edits ignore setReadOnly, and a viewer's document is only the lines on screen.
+    CodeEditor *editor = currentEditor();
+    if (!editor || editor->isReadOnly() || qobject_cast<LargeFileViewer*>(editor))
+        return nullptr;
+    return editor;
+}
+
 void Editor::on_actionPreferences_triggered()
 {
     PreferencesDialog dialog(m_settings, statBarVisibility, this);
@@ -836,7 +1029,7 @@ void Editor::zoomIn()
     zoomLevel++; //Track zoom level to save.
     RestoreZoom(zoomLevel);
     SaveSettings();
-    UpdateStatusBar();
+    m_updates->invalidate(StatusUpdate);
 }
 
 void Editor::zoomOut()
@@ -845,7 +1038,7 @@ void Editor::zoomOut()
     if (zoomLevel < -9) zoomLevel = -9; //Nothing below 10%.
     RestoreZoom(zoomLevel);
     SaveSettings();
-    UpdateStatusBar();
+    m_updates->invalidate(StatusUpdate);
 }
 
 void Editor::wheelEvent(QWheelEvent *event)
@@ -860,7 +1053,7 @@ void Editor::wheelEvent(QWheelEvent *event)
     } else {
         QMainWindow::wheelEvent(event);
     }
-    UpdateStatusBar();
+    m_updates->invalidate(StatusUpdate);
 }
 
 void Editor::on_actionZoom_In_triggered()
@@ -892,7 +1085,7 @@ void Editor::applyReadOnly(bool isRO)
     {
         QWidget *currentWidget = ui->editorTabs->widget(i);
         CodeEditor *editor = qobject_cast<CodeEditor*>(currentWidget);
-        if (editor)
+        if (editor && !qobject_cast<LargeFileViewer*>(editor)) //Viewers always stay read-only.
             editor->setReadOnly(isRO);
     }
     ui->actionToggle_Read_Only->setChecked(isRO);
@@ -908,6 +1101,7 @@ void Editor::toggleWordWrap(bool Wrap)
     for (int i = 0; i < ui->editorTabs->count(); i++)
     {
         CodeEditor *editor = qobject_cast<CodeEditor*>(ui->editorTabs->widget(i));
+        if (!editor || qobject_cast<LargeFileViewer*>(editor)) continue; //Viewers rely on one line per block.
         if (Wrap) editor->setLineWrapMode(QPlainTextEdit::WidgetWidth);
         else editor->setLineWrapMode(QPlainTextEdit::NoWrap);
     }
@@ -938,6 +1132,33 @@ void Editor::copySelection()
 
 Editor::~Editor()
 {
+    for (FileLoader *loader : std::as_const(fileLoaders)) //Stop pending loads before the window goes away.
+    {
+        QThread *thread = loader->thread();
+        loader->cancel();
+        thread->quit();
+        thread->wait();
+    }
+    fileLoaders.clear();
+
+    qDebug() << "UI updates: status" << m_updates->performed(StatusUpdate) << "of" << m_updates->requested(StatusUpdate)
+             << "undo/redo" << m_updates->performed(UndoRedoUpdate) << "of" << m_updates->requested(UndoRedoUpdate)
+             << "menus" << m_updates->performed(MenuUpdate) << "of" << m_updates->requested(MenuUpdate)
+             << "absorbed" << m_updates->absorbed();
+
+    for (QThread *thread : findChildren<QThread*>(Qt::FindDirectChildrenOnly)) //Let running saves reach the disk, closed tabs included.
+    {
+        thread->quit();
+        thread->wait();
+    }
+    saveThreads.clear();
+
+    //Saves queued behind those were only replayed from their finished signal, which no longer comes; write them now.
+    QHash<CodeEditor*, QString> pending;
+    pending.swap(pendingSaves);
+    for (auto it = pending.cbegin(); it != pending.cend(); ++it)
+        WriteFile(it.key(), it.value(), true);
+
     SaveSettings(); //Save current configuration.
     saveCurrentTabs();
 
@@ -958,7 +1179,7 @@ void Editor::on_actionSelect_All_triggered()
 
 void Editor::on_actionDate_and_Time_Short_triggered()
 {
-    CodeEditor *editor = currentEditor();
+    CodeEditor *editor = editableEditor();
     if (editor) //Safety.
     {
         QDateTime current = QDateTime::currentDateTime();
@@ -969,7 +1190,7 @@ void Editor::on_actionDate_and_Time_Short_triggered()
 
 void Editor::on_actionDate_and_Time_Long_triggered()
 {
-    CodeEditor *editor = currentEditor();
+    CodeEditor *editor = editableEditor();
     if (editor) //Safety.
     {
         QDateTime current = QDateTime::currentDateTime();
@@ -980,7 +1201,7 @@ void Editor::on_actionDate_and_Time_Long_triggered()
 
 void Editor::on_actionDuplicate_Line_triggered()
 {
-    if (CodeEditor *editor = currentEditor())
+    if (CodeEditor *editor = editableEditor())
     {
         QTextCursor cursor = editor->textCursor();
         cursor.select(QTextCursor::LineUnderCursor);
@@ -991,7 +1212,7 @@ void Editor::on_actionDuplicate_Line_triggered()
 
 void Editor::on_actionDelete_line_triggered()
 {
-    CodeEditor *editor = currentEditor();
+    CodeEditor *editor = editableEditor();
     if (editor)
     {
         QTextCursor cursor = editor->textCursor();
@@ -1003,13 +1224,13 @@ void Editor::on_actionDelete_line_triggered()
 
 void Editor::on_actionDelete_triggered()
 {
-    if (CodeEditor *editor = currentEditor())
+    if (CodeEditor *editor = editableEditor())
         editor->textCursor().deleteChar();
 }
 
 void Editor::on_actionDelete_Word_triggered()
 {
-    if (CodeEditor *editor = currentEditor())
+    if (CodeEditor *editor = editableEditor())
     {
         QTextCursor cursor = editor->textCursor();
 
@@ -1046,7 +1267,7 @@ void Editor::on_actionDelete_Word_triggered()
 
 void Editor::on_actionDelete_to_End_of_Line_triggered()
 {
-    if (CodeEditor *editor = currentEditor())
+    if (CodeEditor *editor = editableEditor())
     {
         QTextCursor cursor = editor->textCursor();
 
@@ -1059,7 +1280,7 @@ void Editor::on_actionDelete_to_End_of_Line_triggered()
 
 void Editor::on_actionUPPERCASE_triggered()
 {
-    if (CodeEditor *editor = currentEditor())
+    if (CodeEditor *editor = editableEditor())
     {
         QTextCursor cursor = editor->textCursor();
         if (cursor.hasSelection())
@@ -1080,7 +1301,7 @@ void Editor::on_actionUPPERCASE_triggered()
 
 void Editor::on_actionLowercase_triggered()
 {
-    if (CodeEditor *editor = currentEditor())
+    if (CodeEditor *editor = editableEditor())
     {
         QTextCursor cursor = editor->textCursor();
 
@@ -1099,7 +1320,7 @@ void Editor::on_actionLowercase_triggered()
 
 void Editor::on_actionPaste_triggered()
 {
-    if (CodeEditor *editor = currentEditor())
+    if (CodeEditor *editor = editableEditor())
     {
         QTextCursor cursor = editor->textCursor();
         QString text = QApplication::clipboard()->text();
@@ -1111,7 +1332,7 @@ void Editor::on_actionPaste_triggered()
 
 void Editor::on_actionCut_triggered()
 {
-    if (CodeEditor *editor = currentEditor())
+    if (CodeEditor *editor = editableEditor())
     {
         QTextCursor cursor = editor->textCursor();
 
@@ -1229,14 +1450,14 @@ void Editor::RedoApperance(bool ava)
 
 void Editor::on_actionUndo_triggered()
 {
-    CodeEditor *editor = currentEditor();
+    CodeEditor *editor = editableEditor();
     if (editor)
         editor->undo();
 }
 
 void Editor::on_actionRedo_triggered()
 {
-    CodeEditor *editor = currentEditor();
+    CodeEditor *editor = editableEditor();
     if (editor)
         editor->redo();
 }
@@ -1248,6 +1469,7 @@ void Editor::saveCurrentTabs()
     for (int i = 0; i < ui->editorTabs->count(); i++)
     {
         CodeEditor *editor = qobject_cast<CodeEditor*>(ui->editorTabs->widget(i));
+        if (qobject_cast<LargeFileViewer*>(editor)) continue; //Its document is one window of the file, restoring it as a modified copy would overwrite the file.
         if (editor && editor->document()->isModified())
         {
             QString tempPath = saveTempFiles(editor);
@@ -1275,6 +1497,9 @@ void Editor::saveCurrentTabs()
 
 QString Editor::saveTempFiles(CodeEditor *editor)
 {
+    if (qobject_cast<LargeFileViewer*>(editor))
+        return QString();
+
     QString baseName;
     if (filePaths.contains(editor) && !filePaths.value(editor).isEmpty())
     {
@@ -1292,17 +1517,18 @@ QString Editor::saveTempFiles(CodeEditor *editor)
     if (file.open(QIODevice::WriteOnly | QIODevice::Text)) //File opening.
     {
         QStringConverter::Encoding enc = textToEnc(currentEncodings.value(editor));
-        QStringEncoder encoder = QStringEncoder(enc);
-
-        QByteArray data = encoder.encode(editor->toPlainText());
 
-        if(encoder.hasError())
+        //Encode block by block straight into the file rather than through a full copy of the document.
+        DocumentWriter writer(editor->document());
+        writer.setEncoding(enc);
+        if (!writer.write(&file) && writer.hasEncodingError())
         {
-            QStringEncoder fallBackenc = QStringEncoder(QStringConverter::Encoding::Utf8);
-            data = fallBackenc.encode(editor->toPlainText());
+            file.resize(0); //Start over in UTF-8.
+            file.seek(0);
+            writer.setEncoding(QStringConverter::Encoding::Utf8);
+            writer.write(&file);
         }
 
-        file.write(data);
         file.close();
 
         return filePath;
@@ -1357,22 +1583,7 @@ void Editor::restoreSeccionFile(const QString &tempPath, const QString &original
         editor->document()->setModified(isModified); // Restore modified state
 
         // Set up editor connections
-        editor->editorActions(ui->actionCut, ui->actionCopy, ui->actionPaste,
-                              ui->actionSelect_All, ui->actionUPPERCASE,
-                              ui->actionLowercase, ui->actionSearch_on_Web);
-
-        connect(editor, &QPlainTextEdit::cursorPositionChanged, this, &Editor::UpdateStatusBar);
-        connect(editor, &QPlainTextEdit::textChanged, this, &Editor::UpdateStatusBar);
-        connect(editor, &QPlainTextEdit::modificationChanged, this, &Editor::FileEdited);
-        connect(editor, &QPlainTextEdit::undoAvailable, this, &Editor::UndoApperance);
-        connect(editor, &QPlainTextEdit::redoAvailable, this, &Editor::RedoApperance);
-        connect(editor, &CodeEditor::zoomInRequested, this, &Editor::zoomIn);
-        connect(editor, &CodeEditor::zoomOutRequested, this, &Editor::zoomOut);
-        connect(editor, &CodeEditor::cutRequested, this, &Editor::on_actionCut_triggered);
-        connect(editor, &CodeEditor::copyRequested, this, &Editor::copySelection);
-        connect(editor, &CodeEditor::pasteRequested, this, &Editor::on_actionPaste_triggered);
-        connect(editor, &CodeEditor::selectAllRequested, this, &Editor::on_actionSelect_All_triggered);
-        connect(editor, &CodeEditor::selectionStateChanged, this, &Editor::selectionTrack);
+        SetupEditor(editor);
 
         // Restore file metadata
         if (!originalPath.isEmpty()) {
@@ -1438,7 +1649,7 @@ void Editor::on_actionRestore_Default_Zoom_triggered()
         if(editor)
             editor->setZoomLevel(0);
     }
-    UpdateStatusBar();
+    m_updates->invalidate(StatusUpdate);
 }
 
 void Editor::on_actionGo_To_triggered()
@@ -1482,7 +1693,7 @@ void Editor::on_actionWindows_CR_LF_triggered()
     ui->actionWindows_CR_LF->setEnabled(false);
     ui->actionUnix_LF->setEnabled(true);
     ui->actionMacintosh_RC->setEnabled(true);
-    UpdateStatusBar();
+    m_updates->invalidate(StatusUpdate);
 }
 
 void Editor::on_actionUnix_LF_triggered()
@@ -1492,7 +1703,7 @@ void Editor::on_actionUnix_LF_triggered()
     ui->actionUnix_LF->setEnabled(false);
     ui->actionWindows_CR_LF->setEnabled(true);
     ui->actionMacintosh_RC->setEnabled(true);
-    UpdateStatusBar();
+    m_updates->invalidate(StatusUpdate);
 }
 
 void Editor::on_actionMacintosh_RC_triggered()
@@ -1502,7 +1713,7 @@ void Editor::on_actionMacintosh_RC_triggered()
     ui->actionMacintosh_RC->setEnabled(false);
     ui->actionWindows_CR_LF->setEnabled(true);
     ui->actionUnix_LF->setEnabled(true);
-    UpdateStatusBar();
+    m_updates->invalidate(StatusUpdate);
 }
 
 void Editor::on_actionOpen_Recent_Closed_triggered()
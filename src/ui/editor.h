@@ -23,6 +23,9 @@
 #include "src/core/encdetector.h"
 #include "src/dialogs/findandreplace.h"
 #include "src/core/spellchecker.h"
+#include "src/core/fileloader.h"
+#include "src/core/filesaver.h"
+#include "src/core/updatescheduler.h"
 #include <QMenu>
 #include <QActionGroup>
 #include <QMainWindow>
@@ -38,11 +41,24 @@ class Editor : public QMainWindow
     Q_OBJECT
 
 public:
+    enum UpdatePart : quint32 //Parts of the window refreshed through m_updates.
+    {
+        StatusUpdate = 0x1,
+        UndoRedoUpdate = 0x2,
+        MenuUpdate = 0x4,
+        SelectionUpdate = 0x8
+    };
+
     explicit Editor( SpellChecker *checker, QWidget *parent = nullptr);
-    void OpenFile(const QString &FilePath);
+    void OpenFile(const QString &OpenTarget); //A path, or "path:line[:column]".
+    bool OpenInViewer(const QString &FilePath);
+    void FileLoaded(CodeEditor *editor, const FileLoadResult &result);
+    void CancelLoad(CodeEditor *editor);
+    void SetupEditor(CodeEditor *editor);
     void SaveSettings();
     void LoadSettings();
     void UpdateStatusBar();
+    void UpdateMenus();
     void CreateEncMenu();
     void onEncodingActionSelected(QAction *selectedAction);
     void UpdateUndoRedo();
@@ -51,9 +67,11 @@ public:
     void FileEdited(bool edited);
     void resetTabState(CodeEditor *editor, bool edited);
     void AutoSave();
-    bool SaveAs(CodeEditor* editor);
-    bool Save(CodeEditor* editor);
+    bool SaveAs(CodeEditor* editor, bool wait = false);
+    bool Save(CodeEditor* editor, bool wait = false); //Saves in the background unless wait is set.
+    bool WriteFile(CodeEditor *editor, const QString &filePath, bool wait);
     CodeEditor* currentEditor() const;
+    CodeEditor* editableEditor() const; //Current editor unless it is read-only or a viewer, the edit actions go through it.
     void RestoreZoom(int zoom);
     void zoomIn();
     void zoomOut();
@@ -156,6 +174,11 @@ private:
     QActionGroup *encActionGrp;
     QHash<CodeEditor*, QString> lineEndings;
     SpellChecker *m_checker;
+    UpdateScheduler *m_updates;
+    QHash<CodeEditor*, FileLoader*> fileLoaders;
+    QHash<CodeEditor*, QThread*> saveThreads; //Background save running for the tab.
+    QHash<CodeEditor*, QPair<qint64, int>> pendingGoTo; //Line and column to show once the file is loaded.
+    QHash<CodeEditor*, QString> pendingSaves; //Saves requested while another one was writing.
 
 protected:
     void dragEnterEvent(QDragEnterEvent *event) override;
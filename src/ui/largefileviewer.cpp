@@ -0,0 +1,218 @@
+/*
+ * Edito - A modern, cross-platform text editor
+ * Copyright (C) 2025 Yovsky <Yovsky@proton.me>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "largefileviewer.h"
+#include <QTextBlock>
+#include <QWheelEvent>
+#include <QKeyEvent>
+#include <climits>
+
+LargeFileViewer::LargeFileViewer(MappedFile *file, QWidget *parent, SpellChecker *checker)
+    : CodeEditor(parent, checker)
+    , m_file(file)
+    , m_scroll(new QScrollBar(Qt::Vertical, this))
+    , m_firstLine(0)
+    , m_pendingLine(-1)
+    , m_pendingColumn(0)
+{
+    m_file->setParent(this);
+
+    setReadOnly(true);
+    setLineWrapMode(NoWrap); //One block per file line, the window math depends on it.
+    setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOff); //The document is one screen long, m_scroll does the scrolling.
+
+    m_rightMargin = m_scroll->sizeHint().width();
+    updateLineNumberAreaWidth(0);
+
+    connect(m_scroll, &QScrollBar::valueChanged, this, [this](int value) {
+        if (value == m_firstLine) return;
+        m_firstLine = value;
+        reloadWindow();
+    });
+    connect(m_file, &MappedFile::indexProgress, this, &LargeFileViewer::updateScrollRange);
+    connect(m_file, &MappedFile::indexFinished, this, &LargeFileViewer::updateScrollRange);
+
+    updateScrollRange();
+    reloadWindow();
+}
+
+MappedFile *LargeFileViewer::mappedFile() const
+{
+    return m_file;
+}
+
+qint64 LargeFileViewer::currentLine() const
+{
+    return m_firstLine + textCursor().blockNumber();
+}
+
+qint64 LargeFileViewer::firstLineNumber() const
+{
+    return m_firstLine;
+}
+
+qint64 LargeFileViewer::totalLineCount() const
+{
+    return m_file->lineCount();
+}
+
+qint64 LargeFileViewer::currentOffset() const
+{
+    return m_file->lineOffset(currentLine());
+}
+
+qint64 LargeFileViewer::totalLength() const
+{
+    return m_file->size();
+}
+
+void LargeFileViewer::goToLine(qint64 line, int column)
+{
+    if (line >= m_file->lineCount() && !m_file->isIndexComplete())
+    {
+        m_pendingLine = line; //Retried from updateScrollRange() as the index grows.
+        m_pendingColumn = column;
+        return;
+    }
+    m_pendingLine = -1;
+
+    line = qBound<qint64>(0, line, m_file->lineCount() - 1);
+    scrollToLine(line);
+
+    QTextBlock target = document()->findBlockByNumber(int(qBound<qint64>(0, line - m_firstLine, blockCount() - 1)));
+    QTextCursor cursor(target);
+    cursor.setPosition(target.position() + qBound(0, column, target.length() - 1));
+    setTextCursor(cursor);
+}
+
+void LargeFileViewer::goToOffset(qint64 offset)
+{
+    qint64 line = m_file->lineAt(qBound<qint64>(0, offset, m_file->size() - 1)); //Checkpoint lookup, then a short walk.
+    if (line >= 0)
+        goToLine(line);
+}
+
+void LargeFileViewer::scrollToLine(qint64 line)
+{
+    m_scroll->setValue(int(qBound<qint64>(0, line, m_scroll->maximum())));
+}
+
+int LargeFileViewer::visibleLines() const
+{
+    return qMax(1, viewport()->height() / qMax(1, fontMetrics().height()));
+}
+
+void LargeFileViewer::updateScrollRange()
+{
+    //QScrollBar is int based, files with more lines than that stop at INT_MAX.
+    qint64 maxFirst = qMax<qint64>(0, m_file->lineCount() - visibleLines());
+    m_scroll->setRange(0, int(qMin<qint64>(maxFirst, INT_MAX)));
+    m_scroll->setPageStep(visibleLines());
+
+    if (blockCount() < visibleLines() + 1)
+        reloadWindow(); //More lines got indexed while the window was short.
+    updateLineNumberAreaWidth(0);
+
+    if (m_pendingLine >= 0 && (m_pendingLine < m_file->lineCount() || m_file->isIndexComplete()))
+        goToLine(m_pendingLine, m_pendingColumn);
+}
+
+void LargeFileViewer::reloadWindow()
+{
+    QTextCursor cursor = textCursor();
+    int block = cursor.blockNumber();
+    int column = cursor.positionInBlock();
+
+    setPlainText(m_file->readLines(m_firstLine, visibleLines() + 1)); //One extra line for the partially visible one.
+
+    //Keep the cursor on the same screen row.
+    QTextBlock target = document()->findBlockByNumber(qMin(block, blockCount() - 1));
+    cursor = QTextCursor(target);
+    cursor.setPosition(target.position() + qMin(column, target.length() - 1));
+    setTextCursor(cursor);
+}
+
+void LargeFileViewer::resizeEvent(QResizeEvent *event)
+{
+    CodeEditor::resizeEvent(event);
+
+    QRect cr = contentsRect();
+    m_scroll->setGeometry(QRect(cr.right() - m_rightMargin + 1, cr.top(), m_rightMargin, cr.height()));
+
+    updateScrollRange();
+    reloadWindow();
+}
+
+void LargeFileViewer::wheelEvent(QWheelEvent *event)
+{
+    if (event->modifiers() & Qt::ControlModifier)
+    {
+        event->ignore(); //Let the Editor window handle zooming.
+        return;
+    }
+    int steps = event->angleDelta().y() / 40; //Three lines per notch.
+    m_scroll->setValue(m_scroll->value() - steps);
+    event->accept();
+}
+
+void LargeFileViewer::keyPressEvent(QKeyEvent *event)
+{
+    int block = textCursor().blockNumber();
+    bool ctrl = event->modifiers() & Qt::ControlModifier;
+
+    switch (event->key())
+    {
+    case Qt::Key_Up:
+        if (block == 0)
+        {
+            m_scroll->setValue(m_scroll->value() - 1);
+            return;
+        }
+        break;
+    case Qt::Key_Down:
+        if (block >= visibleLines() - 1)
+        {
+            m_scroll->setValue(m_scroll->value() + 1);
+            return;
+        }
+        break;
+    case Qt::Key_PageUp:
+        m_scroll->setValue(m_scroll->value() - visibleLines());
+        return;
+    case Qt::Key_PageDown:
+        m_scroll->setValue(m_scroll->value() + visibleLines());
+        return;
+    case Qt::Key_Home:
+        if (ctrl)
+        {
+            m_scroll->setValue(0);
+            return;
+        }
+        break;
+    case Qt::Key_End:
+        if (ctrl)
+        {
+            m_scroll->setValue(m_scroll->maximum());
+            return;
+        }
+        break;
+    default:
+        break;
+    }
+    CodeEditor::keyPressEvent(event);
+}
@@ -0,0 +1,62 @@
+#ifndef LARGEFILEVIEWER_H
+#define LARGEFILEVIEWER_H
+
+/*
+ * Edito - A modern, cross-platform text editor
+ * Copyright (C) 2025 Yovsky <Yovsky@proton.me>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "src/ui/codeeditor.h"
+#include "src/core/mappedfile.h"
+#include <QScrollBar>
+
+// Read-only CodeEditor over a MappedFile. The document only ever holds the
+// lines on screen; a separate scroll bar walks the whole file.
+class LargeFileViewer : public CodeEditor
+{
+    Q_OBJECT
+
+public:
+    explicit LargeFileViewer(MappedFile *file, QWidget *parent = nullptr, SpellChecker *checker = nullptr);
+
+    MappedFile *mappedFile() const;
+    qint64 currentLine() const override; //Absolute line of the text cursor.
+    qint64 currentOffset() const override; //Byte offset of the cursor's line.
+    qint64 totalLineCount() const override;
+    qint64 totalLength() const override;
+    void goToLine(qint64 line, int column = 0) override; //Waits for the index if the line isn't reached yet.
+    void goToOffset(qint64 offset) override;
+    void scrollToLine(qint64 line);
+
+protected:
+    qint64 firstLineNumber() const override;
+    void resizeEvent(QResizeEvent *event) override;
+    void wheelEvent(QWheelEvent *event) override;
+    void keyPressEvent(QKeyEvent *event) override;
+
+private:
+    void reloadWindow();
+    void updateScrollRange();
+    int visibleLines() const;
+
+    MappedFile *m_file;
+    QScrollBar *m_scroll;
+    qint64 m_firstLine;
+    qint64 m_pendingLine; //Go-to target past the indexed lines, -1 if none.
+    int m_pendingColumn;
+};
+
+#endif // LARGEFILEVIEWER_H
@@ -78,6 +78,7 @@
 #include <chrono>
 #include <memory>
 #include <limits>
+#include <map>
 #include <string>
 #include <vector>
 
@@ -163,6 +164,8 @@ AffixMgr::AffixMgr(const char* affpath,
     sStart[i] = nullptr;
     pFlag[i] = nullptr;
     sFlag[i] = nullptr;
+    pfx_first[i] = -1;
+    sfx_first[i] = -1;
   }
 
   memset(contclasses, 0, CONTSIZE * sizeof(char));
@@ -742,6 +745,9 @@ int AffixMgr::parse_file(const char* affpath, const char* key) {
   process_pfx_order();
   process_sfx_order();
 
+  // and copy the result into arrays for the searches
+  flatten_affix_trees();
+
   return 0;
 }
 
@@ -1007,6 +1013,68 @@ int AffixMgr::process_sfx_order() {
   return 0;
 }
 
+// copy the prefix and suffix lists into pfx_nodes and sfx_nodes, the
+// searches walk these instead of following the entry links, see AffixNode
+void AffixMgr::flatten_affix_trees() {
+  affix_keys.clear();
+  pfx_nodes.clear();
+  sfx_nodes.clear();
+  for (int i = 0; i < SETSIZE; i++) {
+    pfx_first[i] = flatten_affix_list(pStart[i], i == 0, pfx_nodes);
+    sfx_first[i] = flatten_affix_list(sStart[i], i == 0, sfx_nodes);
+  }
+}
+
+// append the list at start to nodes and return the index of its first node,
+// the nodes of a plain list (the 0 length affixes) are chained by nexteq
+template <class T>
+int32_t AffixMgr::flatten_affix_list(T* start,
+                                     bool list,
+                                     std::vector<AffixNode>& nodes) {
+  if (!start)
+    return -1;
+
+  const auto first = static_cast<int32_t>(nodes.size());
+  std::map<const T*, int32_t> index;
+  for (T* ptr = start; ptr; ptr = ptr->getNext())
+    index.emplace(ptr, static_cast<int32_t>(first + index.size()));
+  auto node_of = [&index](const T* ptr) {
+    return ptr ? index.at(ptr) : -1;
+  };
+
+  for (T* ptr = start; ptr; ptr = ptr->getNext()) {
+    AffixNode node;
+    node.entry = ptr;
+    node.key = static_cast<uint32_t>(affix_keys.size());
+    affix_keys.append(ptr->getKey());
+    affix_keys.push_back('\0');
+    node.flag = ptr->getFlag();
+    node.cont = 0;
+    const unsigned short* cont = ptr->getCont();
+    const unsigned short contlen = ptr->getContLen();
+    if (cont) {
+      node.cont |= affCONT;
+      if (TESTAFF(cont, compoundpermitflag, contlen))
+        node.cont |= affCOMPOUNDPERMIT;
+      if (TESTAFF(cont, circumfix, contlen))
+        node.cont |= affCIRCUMFIX;
+      if (TESTAFF(cont, onlyincompound, contlen))
+        node.cont |= affONLYINCOMPOUND;
+      if (TESTAFF(cont, needaffix, contlen))
+        node.cont |= affNEEDAFFIX;
+    }
+    if (list) {
+      node.nexteq = node_of(ptr->getNext());
+      node.nextne = -1;
+    } else {
+      node.nexteq = node_of(ptr->getNextEQ());
+      node.nextne = node_of(ptr->getNextNE());
+    }
+    nodes.push_back(node);
+  }
+  return first;
+}
+
 // add flags to the result for dictionary debugging
 std::string& AffixMgr::debugflag(std::string& result, unsigned short flag) {
   std::string st = encode_flag(flag);
@@ -1089,52 +1157,47 @@ struct hentry* AffixMgr::prefix_check(const std::string& word,
   sfxextra = 0;
 
   // first handle the special case of 0 length prefixes
-  PfxEntry* pe = pStart[0];
-  while (pe) {
+  for (int32_t n = pfx_first[0]; n >= 0; n = pfx_nodes[n].nexteq) {
+    const AffixNode& node = pfx_nodes[n];
     if (
         // fogemorpheme
-        ((in_compound != IN_CPD_NOT) ||
-         !(pe->getCont() &&
-           (TESTAFF(pe->getCont(), onlyincompound, pe->getContLen())))) &&
+        ((in_compound != IN_CPD_NOT) || !(node.cont & affONLYINCOMPOUND)) &&
         // permit prefixes in compounds
-        ((in_compound != IN_CPD_END) ||
-         (pe->getCont() &&
-          (TESTAFF(pe->getCont(), compoundpermitflag, pe->getContLen()))))) {
+        ((in_compound != IN_CPD_END) || (node.cont & affCOMPOUNDPERMIT))) {
       // check prefix
+      PfxEntry* pe = static_cast<PfxEntry*>(node.entry);
       rv = pe->checkword(word, start, len, in_compound, needflag, scratch);
       if (rv) {
         pfx = pe;  // BUG: pfx not stateless
         return rv;
       }
     }
-    pe = pe->getNext();
   }
 
   // now handle the general case
   unsigned char sp = word[start];
-  PfxEntry* pptr = pStart[sp];
+  const char* keys = affix_keys.c_str();
+  int32_t n = pfx_first[sp];
 
-  while (pptr) {
-    if (isSubset(pptr->getKey(), word.c_str() + start)) {
+  while (n >= 0) {
+    const AffixNode& node = pfx_nodes[n];
+    if (isSubset(keys + node.key, word.c_str() + start)) {
       if (
           // fogemorpheme
-          ((in_compound != IN_CPD_NOT) ||
-           !(pptr->getCont() &&
-             (TESTAFF(pptr->getCont(), onlyincompound, pptr->getContLen())))) &&
+          ((in_compound != IN_CPD_NOT) || !(node.cont & affONLYINCOMPOUND)) &&
           // permit prefixes in compounds
-          ((in_compound != IN_CPD_END) ||
-           (pptr->getCont() && (TESTAFF(pptr->getCont(), compoundpermitflag,
-                                        pptr->getContLen()))))) {
+          ((in_compound != IN_CPD_END) || (node.cont & affCOMPOUNDPERMIT))) {
         // check prefix
+        PfxEntry* pptr = static_cast<PfxEntry*>(node.entry);
         rv = pptr->checkword(word, start, len, in_compound, needflag, scratch);
         if (rv) {
           pfx = pptr;  // BUG: pfx not stateless
           return rv;
         }
       }
-      pptr = pptr->getNextEQ();
+      n = node.nexteq;
     } else {
-      pptr = pptr->getNextNE();
+      n = node.nextne;
     }
   }
 
@@ -1155,29 +1218,30 @@ struct hentry* AffixMgr::prefix_check_twosfx(const std::string& word,
   sfxextra = 0;
 
   // first handle the special case of 0 length prefixes
-  PfxEntry* pe = pStart[0];
-
-  while (pe) {
+  for (int32_t n = pfx_first[0]; n >= 0; n = pfx_nodes[n].nexteq) {
+    PfxEntry* pe = static_cast<PfxEntry*>(pfx_nodes[n].entry);
     rv = pe->check_twosfx(word, start, len, in_compound, needflag, scratch);
     if (rv)
       return rv;
-    pe = pe->getNext();
   }
 
   // now handle the general case
   unsigned char sp = word[start];
-  PfxEntry* pptr = pStart[sp];
+  const char* keys = affix_keys.c_str();
+  int32_t n = pfx_first[sp];
 
-  while (pptr) {
-    if (isSubset(pptr->getKey(), word.c_str() + start)) {
+  while (n >= 0) {
+    const AffixNode& node = pfx_nodes[n];
+    if (isSubset(keys + node.key, word.c_str() + start)) {
+      PfxEntry* pptr = static_cast<PfxEntry*>(node.entry);
       rv = pptr->check_twosfx(word, start, len, in_compound, needflag, scratch);
       if (rv) {
         pfx = pptr;
         return rv;
       }
-      pptr = pptr->getNextEQ();
+      n = node.nexteq;
     } else {
-      pptr = pptr->getNextNE();
+      n = node.nextne;
     }
   }
 
@@ -1199,21 +1263,23 @@ std::string AffixMgr::prefix_check_morph(const std::string& word,
   sfxextra = 0;
 
   // first handle the special case of 0 length prefixes
-  PfxEntry* pe = pStart[0];
-  while (pe) {
+  for (int32_t n = pfx_first[0]; n >= 0; n = pfx_nodes[n].nexteq) {
+    PfxEntry* pe = static_cast<PfxEntry*>(pfx_nodes[n].entry);
     std::string st = pe->check_morph(word, start, len, in_compound, needflag, scratch);
     if (!st.empty()) {
       result.append(st);
     }
-    pe = pe->getNext();
   }
 
   // now handle the general case
   unsigned char sp = word[start];
-  PfxEntry* pptr = pStart[sp];
+  const char* keys = affix_keys.c_str();
+  int32_t n = pfx_first[sp];
 
-  while (pptr) {
-    if (isSubset(pptr->getKey(), word.c_str() + start)) {
+  while (n >= 0) {
+    const AffixNode& node = pfx_nodes[n];
+    if (isSubset(keys + node.key, word.c_str() + start)) {
+      PfxEntry* pptr = static_cast<PfxEntry*>(node.entry);
       std::string st = pptr->check_morph(word, start, len, in_compound, needflag, scratch);
       if (!st.empty()) {
         // fogemorpheme
@@ -1224,9 +1290,9 @@ std::string AffixMgr::prefix_check_morph(const std::string& word,
           pfx = pptr;
         }
       }
-      pptr = pptr->getNextEQ();
+      n = node.nexteq;
     } else {
-      pptr = pptr->getNextNE();
+      n = node.nextne;
     }
   }
 
@@ -1247,29 +1313,31 @@ std::string AffixMgr::prefix_check_twosfx_morph(const std::string& word,
   sfxextra = 0;
 
   // first handle the special case of 0 length prefixes
-  PfxEntry* pe = pStart[0];
-  while (pe) {
+  for (int32_t n = pfx_first[0]; n >= 0; n = pfx_nodes[n].nexteq) {
+    PfxEntry* pe = static_cast<PfxEntry*>(pfx_nodes[n].entry);
     std::string st = pe->check_twosfx_morph(word, start, len, in_compound, needflag, scratch);
     if (!st.empty()) {
       result.append(st);
     }
-    pe = pe->getNext();
   }
 
   // now handle the general case
   unsigned char sp = word[start];
-  PfxEntry* pptr = pStart[sp];
+  const char* keys = affix_keys.c_str();
+  int32_t n = pfx_first[sp];
 
-  while (pptr) {
-    if (isSubset(pptr->getKey(), word.c_str() + start)) {
+  while (n >= 0) {
+    const AffixNode& node = pfx_nodes[n];
+    if (isSubset(keys + node.key, word.c_str() + start)) {
+      PfxEntry* pptr = static_cast<PfxEntry*>(node.entry);
       std::string st = pptr->check_twosfx_morph(word, start, len, in_compound, needflag, scratch);
       if (!st.empty()) {
         result.append(st);
         pfx = pptr;
       }
-      pptr = pptr->getNextEQ();
+      n = node.nexteq;
     } else {
-      pptr = pptr->getNextNE();
+      n = node.nextne;
     }
   }
 
@@ -2733,38 +2801,32 @@ struct hentry* AffixMgr::suffix_check(const std::string& word,
   struct hentry* rv = nullptr;
   PfxEntry* ep = ppfx;
 
-  // first handle the special case of 0 length suffixes
-  SfxEntry* se = sStart[0];
+  // the prefix side of the circumfix and needaffix checks is the same for
+  // every suffix
+  const bool pfx_circumfix =
+      ppfx && ep->getCont() &&
+      TESTAFF(ep->getCont(), circumfix, ep->getContLen());
+  const bool pfx_needaffix =
+      ppfx && ep->getCont() &&
+      TESTAFF(ep->getCont(), needaffix, ep->getContLen());
 
-  while (se) {
-    if (!cclass || se->getCont()) {
+  // first handle the special case of 0 length suffixes
+  for (int32_t n = sfx_first[0]; n >= 0; n = sfx_nodes[n].nexteq) {
+    const AffixNode& node = sfx_nodes[n];
+    if (!cclass || (node.cont & affCONT)) {
       // suffixes are not allowed in beginning of compounds
       if ((((in_compound != IN_CPD_BEGIN)) ||  // && !cclass
            // except when signed with compoundpermitflag flag
-           (se->getCont() && compoundpermitflag &&
-            TESTAFF(se->getCont(), compoundpermitflag, se->getContLen()))) &&
+           (compoundpermitflag && (node.cont & affCOMPOUNDPERMIT))) &&
+          // circumfix flag in both prefix and suffix or in neither
           (!circumfix ||
-           // no circumfix flag in prefix and suffix
-           ((!ppfx || !(ep->getCont()) ||
-             !TESTAFF(ep->getCont(), circumfix, ep->getContLen())) &&
-            (!se->getCont() ||
-             !(TESTAFF(se->getCont(), circumfix, se->getContLen())))) ||
-           // circumfix flag in prefix AND suffix
-           ((ppfx && (ep->getCont()) &&
-             TESTAFF(ep->getCont(), circumfix, ep->getContLen())) &&
-            (se->getCont() &&
-             (TESTAFF(se->getCont(), circumfix, se->getContLen()))))) &&
+           pfx_circumfix == ((node.cont & affCIRCUMFIX) != 0)) &&
           // fogemorpheme
-          (in_compound ||
-           !(se->getCont() &&
-             (TESTAFF(se->getCont(), onlyincompound, se->getContLen())))) &&
+          (in_compound || !(node.cont & affONLYINCOMPOUND)) &&
           // needaffix on prefix or first suffix
-          (cclass ||
-           !(se->getCont() &&
-             TESTAFF(se->getCont(), needaffix, se->getContLen())) ||
-           (ppfx &&
-            !((ep->getCont()) &&
-              TESTAFF(ep->getCont(), needaffix, ep->getContLen()))))) {
+          (cclass || !(node.cont & affNEEDAFFIX) ||
+           (ppfx && !pfx_needaffix))) {
+        SfxEntry* se = static_cast<SfxEntry*>(node.entry);
         rv = se->checkword(word, start, len, sfxopts, ppfx,
                            (FLAG)cclass, needflag,
                            (in_compound ? 0 : onlyincompound),
@@ -2775,48 +2837,33 @@ struct hentry* AffixMgr::suffix_check(const std::string& word,
         }
       }
     }
-    se = se->getNext();
   }
 
   // now handle the general case
   if (len == 0)
     return nullptr;  // FULLSTRIP
   unsigned char sp = word[start + len - 1];
-  SfxEntry* sptr = sStart[sp];
+  const char* keys = affix_keys.c_str();
+  int32_t n = sfx_first[sp];
 
-  while (sptr) {
-    if (isRevSubset(sptr->getKey(), word.c_str() + start + len - 1, len)) {
+  while (n >= 0) {
+    const AffixNode& node = sfx_nodes[n];
+    if (isRevSubset(keys + node.key, word.c_str() + start + len - 1, len)) {
       // suffixes are not allowed in beginning of compounds
       if ((((in_compound != IN_CPD_BEGIN)) ||  // && !cclass
            // except when signed with compoundpermitflag flag
-           (sptr->getCont() && compoundpermitflag &&
-            TESTAFF(sptr->getCont(), compoundpermitflag,
-                    sptr->getContLen()))) &&
+           (compoundpermitflag && (node.cont & affCOMPOUNDPERMIT))) &&
+          // circumfix flag in both prefix and suffix or in neither
           (!circumfix ||
-           // no circumfix flag in prefix and suffix
-           ((!ppfx || !(ep->getCont()) ||
-             !TESTAFF(ep->getCont(), circumfix, ep->getContLen())) &&
-            (!sptr->getCont() ||
-             !(TESTAFF(sptr->getCont(), circumfix, sptr->getContLen())))) ||
-           // circumfix flag in prefix AND suffix
-           ((ppfx && (ep->getCont()) &&
-             TESTAFF(ep->getCont(), circumfix, ep->getContLen())) &&
-            (sptr->getCont() &&
-             (TESTAFF(sptr->getCont(), circumfix, sptr->getContLen()))))) &&
+           pfx_circumfix == ((node.cont & affCIRCUMFIX) != 0)) &&
           // fogemorpheme
-          (in_compound ||
-           !((sptr->getCont() && (TESTAFF(sptr->getCont(), onlyincompound,
-                                          sptr->getContLen()))))) &&
+          (in_compound || !(node.cont & affONLYINCOMPOUND)) &&
           // needaffix on prefix or first suffix
-          (cclass ||
-           !(sptr->getCont() &&
-             TESTAFF(sptr->getCont(), needaffix, sptr->getContLen())) ||
-           (ppfx &&
-            !((ep->getCont()) &&
-              TESTAFF(ep->getCont(), needaffix, ep->getContLen())))))
+          (cclass || !(node.cont & affNEEDAFFIX) ||
+           (ppfx && !pfx_needaffix)))
         if (in_compound != IN_CPD_END || ppfx ||
-            !(sptr->getCont() &&
-              TESTAFF(sptr->getCont(), onlyincompound, sptr->getContLen()))) {
+            !(node.cont & affONLYINCOMPOUND)) {
+          SfxEntry* sptr = static_cast<SfxEntry*>(node.entry);
           rv = sptr->checkword(word, start, len, sfxopts, ppfx,
                                cclass, needflag,
                                (in_compound ? 0 : onlyincompound),
@@ -2836,9 +2883,9 @@ struct hentry* AffixMgr::suffix_check(const std::string& word,
             return rv;
           }
         }
-      sptr = sptr->getNextEQ();
+      n = node.nexteq;
     } else {
-      sptr = sptr->getNextNE();
+      n = node.nextne;
     }
   }
 
@@ -2856,25 +2903,28 @@ struct hentry* AffixMgr::suffix_check_twosfx(const std::string& word,
   struct hentry* rv = nullptr;
 
   // first handle the special case of 0 length suffixes
-  SfxEntry* se = sStart[0];
-  while (se) {
-    if (contclasses[se->getFlag()]) {
+  for (int32_t n = sfx_first[0]; n >= 0; n = sfx_nodes[n].nexteq) {
+    const AffixNode& node = sfx_nodes[n];
+    if (contclasses[node.flag]) {
+      SfxEntry* se = static_cast<SfxEntry*>(node.entry);
       rv = se->check_twosfx(word, start, len, sfxopts, ppfx, needflag, scratch);
       if (rv)
         return rv;
     }
-    se = se->getNext();
   }
 
   // now handle the general case
   if (len == 0)
     return nullptr;  // FULLSTRIP
   unsigned char sp = word[start + len - 1];
-  SfxEntry* sptr = sStart[sp];
-
-  while (sptr) {
-    if (isRevSubset(sptr->getKey(), word.c_str() + start + len - 1, len)) {
-      if (contclasses[sptr->getFlag()]) {
+  const char* keys = affix_keys.c_str();
+  int32_t n = sfx_first[sp];
+
+  while (n >= 0) {
+    const AffixNode& node = sfx_nodes[n];
+    if (isRevSubset(keys + node.key, word.c_str() + start + len - 1, len)) {
+      if (contclasses[node.flag]) {
+        SfxEntry* sptr = static_cast<SfxEntry*>(node.entry);
         rv = sptr->check_twosfx(word, start, len, sfxopts, ppfx, needflag, scratch);
         if (rv) {
           sfxflag = sptr->getFlag();  // BUG: sfxflag not stateless
@@ -2883,9 +2933,9 @@ struct hentry* AffixMgr::suffix_check_twosfx(const std::string& word,
           return rv;
         }
       }
-      sptr = sptr->getNextEQ();
+      n = node.nexteq;
     } else {
-      sptr = sptr->getNextNE();
+      n = node.nextne;
     }
   }
 
@@ -2905,9 +2955,10 @@ std::string AffixMgr::suffix_check_twosfx_morph(const std::string& word,
   std::string result3;
 
   // first handle the special case of 0 length suffixes
-  SfxEntry* se = sStart[0];
-  while (se) {
-    if (contclasses[se->getFlag()]) {
+  for (int32_t n = sfx_first[0]; n >= 0; n = sfx_nodes[n].nexteq) {
+    const AffixNode& node = sfx_nodes[n];
+    if (contclasses[node.flag]) {
+      SfxEntry* se = static_cast<SfxEntry*>(node.entry);
       std::string st = se->check_twosfx_morph(word, start, len, sfxopts, ppfx, needflag, scratch);
       if (!st.empty()) {
         if (ppfx) {
@@ -2926,18 +2977,20 @@ std::string AffixMgr::suffix_check_twosfx_morph(const std::string& word,
         result.push_back(MSEP_REC);
       }
     }
-    se = se->getNext();
   }
 
   // now handle the general case
   if (len == 0)
     return { };  // FULLSTRIP
   unsigned char sp = word[start + len - 1];
-  SfxEntry* sptr = sStart[sp];
-
-  while (sptr) {
-    if (isRevSubset(sptr->getKey(), word.c_str() + start + len - 1, len)) {
-      if (contclasses[sptr->getFlag()]) {
+  const char* keys = affix_keys.c_str();
+  int32_t n = sfx_first[sp];
+
+  while (n >= 0) {
+    const AffixNode& node = sfx_nodes[n];
+    if (isRevSubset(keys + node.key, word.c_str() + start + len - 1, len)) {
+      if (contclasses[node.flag]) {
+        SfxEntry* sptr = static_cast<SfxEntry*>(node.entry);
         std::string st = sptr->check_twosfx_morph(word, start, len, sfxopts, ppfx, needflag, scratch);
         if (!st.empty()) {
           sfxflag = sptr->getFlag();  // BUG: sfxflag not stateless
@@ -2957,9 +3010,9 @@ std::string AffixMgr::suffix_check_twosfx_morph(const std::string& word,
           result.append(result2);
         }
       }
-      sptr = sptr->getNextEQ();
+      n = node.nexteq;
     } else {
-      sptr = sptr->getNextNE();
+      n = node.nextne;
     }
   }
 
@@ -2982,8 +3035,8 @@ std::string AffixMgr::suffix_check_morph(const std::string& word,
   PfxEntry* ep = ppfx;
 
   // first handle the special case of 0 length suffixes
-  SfxEntry* se = sStart[0];
-  while (se) {
+  for (int32_t n = sfx_first[0]; n >= 0; n = sfx_nodes[n].nexteq) {
+    SfxEntry* se = static_cast<SfxEntry*>(sfx_nodes[n].entry);
     if (!cclass || se->getCont()) {
       // suffixes are not allowed in beginning of compounds
       if (((((in_compound != IN_CPD_BEGIN)) ||  // && !cclass
@@ -3043,17 +3096,19 @@ std::string AffixMgr::suffix_check_morph(const std::string& word,
         rv = se->get_next_homonym(rv, sfxopts, ppfx, cclass, needflag);
       }
     }
-    se = se->getNext();
   }
 
   // now handle the general case
   if (len == 0)
     return { };  // FULLSTRIP
   unsigned char sp = word[start + len - 1];
-  SfxEntry* sptr = sStart[sp];
+  const char* keys = affix_keys.c_str();
+  int32_t n = sfx_first[sp];
 
-  while (sptr) {
-    if (isRevSubset(sptr->getKey(), word.c_str() + start + len - 1, len)) {
+  while (n >= 0) {
+    const AffixNode& node = sfx_nodes[n];
+    if (isRevSubset(keys + node.key, word.c_str() + start + len - 1, len)) {
+      SfxEntry* sptr = static_cast<SfxEntry*>(node.entry);
       // suffixes are not allowed in beginning of compounds
       if (((((in_compound != IN_CPD_BEGIN)) ||  // && !cclass
             // except when signed with compoundpermitflag flag
@@ -3110,9 +3165,9 @@ std::string AffixMgr::suffix_check_morph(const std::string& word,
         result.push_back(MSEP_REC);
         rv = sptr->get_next_homonym(rv, sfxopts, ppfx, cclass, needflag);
       }
-      sptr = sptr->getNextEQ();
+      n = node.nexteq;
     } else {
-      sptr = sptr->getNextNE();
+      n = node.nextne;
     }
   }
 
@@ -72,6 +72,7 @@
 #define AFFIXMGR_HXX_
 
 #include <chrono>
+#include <cstdint>
 #include <cstdio>
 
 #include <memory>
@@ -88,12 +89,38 @@
 #define dupSFX (1 << 0)
 #define dupPFX (1 << 1)
 
+// continuation class flags of an affix tested by prefix_check and
+// suffix_check, looked up once when the affix trees are flattened
+#define affCONT (1 << 0)
+#define affCOMPOUNDPERMIT (1 << 1)
+#define affCIRCUMFIX (1 << 2)
+#define affONLYINCOMPOUND (1 << 3)
+#define affNEEDAFFIX (1 << 4)
+
 class PfxEntry;
 class SfxEntry;
 
+// one affix of the flattened search trees: the prefix or suffix lists of
+// pStart/sStart in order, with the nexteq/nextne links as array indexes
+// (-1 for none) and the search key stored in AffixMgr::affix_keys, so a
+// search only touches the affix entry itself when the key matches
+struct AffixNode {
+  AffEntry* entry;
+  uint32_t key;         // offset of the key in affix_keys
+  FLAG flag;
+  unsigned short cont;  // aff* flags of the continuation class
+  int32_t nexteq;
+  int32_t nextne;
+};
+
 class AffixMgr {
   PfxEntry* pStart[SETSIZE];
   SfxEntry* sStart[SETSIZE];
+  std::vector<AffixNode> pfx_nodes;
+  std::vector<AffixNode> sfx_nodes;
+  int32_t pfx_first[SETSIZE];  // first node searched for a leading/trailing
+  int32_t sfx_first[SETSIZE];  // byte, index 0 lists the 0 length affixes
+  std::string affix_keys;
   PfxEntry* pFlag[SETSIZE];
   SfxEntry* sFlag[SETSIZE];
   const std::vector<std::unique_ptr<HashMgr>>& alldic;
@@ -393,6 +420,9 @@ class AffixMgr {
   SfxEntry* process_sfx_in_order(SfxEntry* ptr, SfxEntry* nptr);
   int process_pfx_tree_to_list();
   int process_sfx_tree_to_list();
+  void flatten_affix_trees();
+  template <class T>
+  int32_t flatten_affix_list(T* start, bool list, std::vector<AffixNode>& nodes);
   int redundant_condition(char, const std::string& strip, const std::string& cond, int);
   void finishFileMgr(FileMgr* afflst);
 };
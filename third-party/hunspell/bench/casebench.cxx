@@ -0,0 +1,150 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1/GPL 2.0/LGPL 2.1
+ *
+ * Copyright (C) 2002-2022 Németh László
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * Hunspell is based on MySpell which is Copyright (C) 2002 Kevin Hendricks.
+ *
+ * Contributor(s): David Einstein, Davide Prina, Giuseppe Modugno,
+ * Gianluca Turconi, Simon Brouwer, Noll János, Bíró Árpád,
+ * Goldman Eleonóra, Sarlós Tamás, Bencsáth Boldizsár, Halácsy Péter,
+ * Dvornik László, Gefferth András, Nagy Viktor, Varga Dániel, Chris Halls,
+ * Rene Engelhard, Bram Moolenaar, Dafydd Jones, Harri Pitkänen
+ *
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+// Cost per word of the UTF-8 and case helpers of csutil: u8_u16,
+// get_captype_utf8, mkallsmall_utf with mkallcap_utf (counted as one), and
+// u16_u8. casebench uses the SSE2 ASCII paths where the target has them,
+// casebench-scalar is the same code built with HUNSPELL_NO_SSE2. Words are
+// the .dic entries with their upper case and capitalized forms, shuffled;
+// with a word count only that many are used, small enough to stay in cache.
+// Both builds must print the same checksum.
+//
+//   usage: casebench dictionary_base [words]
+
+#include "csutil.hxx"
+#include "langnum.hxx"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    fprintf(stderr, "usage: %s dictionary_base [words]\n", argv[0]);
+    return 1;
+  }
+  std::ifstream in(std::string(argv[1]) + ".dic");
+  std::string line;
+  std::getline(in, line);
+  std::vector<std::string> words;
+  std::mt19937 rng(42);
+  while (std::getline(in, line)) {
+    std::string word = line.substr(0, line.find_first_of("/\t \r"));
+    if (word.empty())
+      continue;
+    words.push_back(word);
+    std::string upper = word;
+    for (auto& c : upper)
+      c = toupper((unsigned char)c);
+    words.push_back(upper);
+    std::string capitalized = word;
+    capitalized[0] = toupper((unsigned char)capitalized[0]);
+    words.push_back(capitalized);
+  }
+  std::shuffle(words.begin(), words.end(), rng);
+  if (argc > 2)
+    words.resize(std::min<size_t>(words.size(), atoi(argv[2])));
+
+  size_t nonascii = 0, bytes = 0;
+  for (const auto& w : words) {
+    nonascii += std::any_of(w.begin(), w.end(), [](char c) { return c & 0x80; });
+    bytes += w.size();
+  }
+  std::vector<std::vector<w_char>> wide(words.size());
+  for (size_t i = 0; i < words.size(); ++i)
+    u8_u16(wide[i], words[i]);
+
+  // checksum of every result, the same with and without SSE2
+  size_t check = 0;
+  std::vector<w_char> u;
+  std::string b;
+  for (size_t i = 0; i < words.size(); ++i) {
+    u8_u16(u, words[i]);
+    check = check * 31 + u.size() + (u.empty() ? 0 : (unsigned short)u.back());
+    check = check * 31 + get_captype_utf8(wide[i], LANG_en);
+    std::vector<w_char> w = wide[i];
+    mkallsmall_utf(w, LANG_en);
+    check = check * 31 + u16_u8(b, w).size() + std::hash<std::string>()(b);
+    mkallcap_utf(w, LANG_en);
+    check = check * 31 + std::hash<std::string>()(u16_u8(b, w));
+  }
+
+  const int reps = std::max<int>(1, 2000000 / std::max<size_t>(words.size(), 1));
+  double best[4] = {1e9, 1e9, 1e9, 1e9};
+  size_t sink = 0;
+  auto ms = [](std::chrono::steady_clock::time_point a, std::chrono::steady_clock::time_point b) {
+    return std::chrono::duration<double, std::milli>(b - a).count();
+  };
+  for (int r = 0; r < 7; ++r) {
+    auto t0 = std::chrono::steady_clock::now();
+    for (int k = 0; k < reps; ++k)
+      for (const auto& w : words)
+        sink += u8_u16(u, w);
+    auto t1 = std::chrono::steady_clock::now();
+    for (int k = 0; k < reps; ++k)
+      for (const auto& w : wide)
+        sink += get_captype_utf8(w, LANG_en);
+    auto t2 = std::chrono::steady_clock::now();
+    for (int k = 0; k < reps; ++k)
+      for (auto& w : wide) {
+        mkallsmall_utf(w, LANG_en);
+        mkallcap_utf(w, LANG_en);
+        sink += w.empty() ? 0 : (unsigned short)w[0];
+      }
+    auto t3 = std::chrono::steady_clock::now();
+    for (int k = 0; k < reps; ++k)
+      for (const auto& w : wide)
+        sink += u16_u8(b, w).size();
+    auto t4 = std::chrono::steady_clock::now();
+    best[0] = std::min(best[0], ms(t0, t1));
+    best[1] = std::min(best[1], ms(t1, t2));
+    best[2] = std::min(best[2], ms(t2, t3) / 2);
+    best[3] = std::min(best[3], ms(t3, t4));
+  }
+  const double n = double(words.size()) * reps / 1e6;
+  printf("%s: %zu words, %.1f bytes avg, %.0f%% non-ASCII | ns per word: u8_u16 %.1f, get_captype_utf8 %.1f, "
+         "mkallsmall/cap_utf %.1f, u16_u8 %.1f | checksum %zx (%zu)\n",
+         argv[1], words.size(), double(bytes) / words.size(), 100.0 * nonascii / words.size(),
+         best[0] / n, best[1] / n, best[2] / n, best[3] / n, check, sink % 7);
+  return 0;
+}
@@ -0,0 +1,96 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1/GPL 2.0/LGPL 2.1
+ *
+ * Copyright (C) 2002-2022 Németh László
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * Hunspell is based on MySpell which is Copyright (C) 2002 Kevin Hendricks.
+ *
+ * Contributor(s): David Einstein, Davide Prina, Giuseppe Modugno,
+ * Gianluca Turconi, Simon Brouwer, Noll János, Bíró Árpád,
+ * Goldman Eleonóra, Sarlós Tamás, Bencsáth Boldizsár, Halácsy Péter,
+ * Dvornik László, Gefferth András, Nagy Viktor, Varga Dániel, Chris Halls,
+ * Rene Engelhard, Bram Moolenaar, Dafydd Jones, Harri Pitkänen
+ *
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+// Load time of a .dic file into a HashMgr, for the parallel parsing in
+// load_tables. Built once per HUNSPELL_LOAD_THREADS cap (see Makefile); the
+// threads actually used are also bounded by the cores and by 16384 lines per
+// thread. The digest covers every bucket chain (words, flags, homonyms) and
+// the REP table, it must not depend on the number of threads.
+//
+//   usage: loadbench-N dictionary_base [runs]
+
+#include "csutil.hxx"
+#include "hashmgr.hxx"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    fprintf(stderr, "usage: %s dictionary_base [runs]\n", argv[0]);
+    return 1;
+  }
+  const std::string base = argv[1];
+  const int runs = argc > 2 ? atoi(argv[2]) : 9;
+  const std::string dic = base + ".dic", aff = base + ".aff";
+
+  std::vector<double> times;
+  for (int r = 0; r < runs; ++r) {
+    auto start = std::chrono::steady_clock::now();
+    HashMgr table(dic.c_str(), aff.c_str());
+    times.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+  }
+  std::sort(times.begin(), times.end());
+
+  HashMgr table(dic.c_str(), aff.c_str());
+  std::string dump;
+  size_t entries = 0;
+  int col = -1;
+  struct hentry* hp = nullptr;
+  while ((hp = table.walk_hashtable(col, hp))) {
+    ++entries;
+    dump += std::to_string(col) + ' ' + hp->word + ' ' + std::to_string(hp->var) + ' ';
+    for (int i = 0; i < hp->alen; ++i)
+      dump += std::to_string(hp->astr[i]) + ',';
+    if (hp->var & H_OPT)
+      dump += std::string(" d:") + HENTRY_DATA(hp);
+    dump += hp->next_homonym ? " h\n" : " -\n";
+  }
+  for (const auto& rep : table.get_reptable())
+    dump += rep.pattern + "->" + rep.outstrings[0] + '\n';
+
+  printf("%s: cap %d threads, %u cores, %zu entries, digest %zx, load best %.1f ms, median %.1f ms (%d runs)\n",
+         base.c_str(), HUNSPELL_LOAD_THREADS, std::thread::hardware_concurrency(), entries,
+         std::hash<std::string>()(dump), times.front(), times[times.size() / 2], runs);
+  return 0;
+}
@@ -0,0 +1,157 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1/GPL 2.0/LGPL 2.1
+ *
+ * Copyright (C) 2002-2022 Németh László
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * Hunspell is based on MySpell which is Copyright (C) 2002 Kevin Hendricks.
+ *
+ * Contributor(s): David Einstein, Davide Prina, Giuseppe Modugno,
+ * Gianluca Turconi, Simon Brouwer, Noll János, Bíró Árpád,
+ * Goldman Eleonóra, Sarlós Tamás, Bencsáth Boldizsár, Halácsy Péter,
+ * Dvornik László, Gefferth András, Nagy Viktor, Varga Dániel, Chris Halls,
+ * Rene Engelhard, Bram Moolenaar, Dafydd Jones, Harri Pitkänen
+ *
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+// Word lookup in a HashMgr: the open addressing index (with its Bloom
+// filter) that lookup() probes, against a walk of the bucket chains the
+// table still keeps, which is what lookup() did before the index. Both run
+// in the same process over the same entries, and must return the same entry
+// for every query. Queries are every .dic word plus a one-letter typo and a
+// +s form of each, shuffled, so about a third are hits.
+//
+// Memory: the heap a HashMgr takes (glibc only) and the part of it the index
+// and the Bloom filter account for. Without them the table is the chains
+// alone, which is what the chained lookup needs.
+//
+//   usage: lookupbench dictionary_base [runs]
+
+#include "hashmgr.hxx"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+static size_t heap_in_use() {
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+  struct mallinfo2 info = mallinfo2();
+  return info.uordblks + info.hblkhd;
+#else
+  return 0;
+#endif
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    fprintf(stderr, "usage: %s dictionary_base [runs]\n", argv[0]);
+    return 1;
+  }
+  const std::string base = argv[1];
+  const int runs = argc > 2 ? atoi(argv[2]) : 15;
+
+  const size_t before = heap_in_use();
+  HashMgr* table = new HashMgr((base + ".dic").c_str(), (base + ".aff").c_str());
+  const size_t heap = heap_in_use() - before;
+
+  // bucket heads, as walk_hashtable gives them: the first entry of each column
+  std::vector<struct hentry*> heads;
+  int col = -1;
+  struct hentry* hp = nullptr;
+  while ((hp = table->walk_hashtable(col, hp))) {
+    if ((size_t)col >= heads.size())
+      heads.resize(col + 1, nullptr);
+    if (!heads[col])
+      heads[col] = hp;
+  }
+  auto lookup_chain = [&](const char* word, size_t len) -> struct hentry* {
+    size_t bucket = table->hash(word, len);
+    struct hentry* dp = bucket < heads.size() ? heads[bucket] : nullptr;
+    for (; dp != nullptr; dp = dp->next) {
+      if (strcmp(word, dp->word) == 0)
+        return dp;
+    }
+    return nullptr;
+  };
+
+  std::ifstream in(base + ".dic");
+  std::string line;
+  std::getline(in, line);
+  std::vector<std::string> words;
+  std::mt19937 rng(7);
+  while (std::getline(in, line)) {
+    std::string word = line.substr(0, line.find_first_of("/\t \r"));
+    if (word.empty())
+      continue;
+    words.push_back(word);
+    std::string typo = word;
+    typo[rng() % typo.size()] = 'a' + rng() % 26;
+    words.push_back(typo);
+    words.push_back(word + "s");
+  }
+  std::shuffle(words.begin(), words.end(), rng);
+
+  size_t hits = 0;
+  for (const auto& w : words) {
+    struct hentry* a = table->lookup(w.c_str(), w.size());
+    if (a != lookup_chain(w.c_str(), w.size())) {
+      fprintf(stderr, "mismatch on %s\n", w.c_str());
+      return 1;
+    }
+    hits += a != nullptr;
+  }
+
+  // alternating, best of runs
+  double index_ns = 1e9, chain_ns = 1e9;
+  size_t sink = 0;
+  for (int r = 0; r < runs; ++r) {
+    auto t0 = std::chrono::steady_clock::now();
+    for (const auto& w : words)
+      sink += table->lookup(w.c_str(), w.size()) != nullptr;
+    auto t1 = std::chrono::steady_clock::now();
+    for (const auto& w : words)
+      sink += lookup_chain(w.c_str(), w.size()) != nullptr;
+    auto t2 = std::chrono::steady_clock::now();
+    index_ns = std::min(index_ns, std::chrono::duration<double, std::nano>(t1 - t0).count() / words.size());
+    chain_ns = std::min(chain_ns, std::chrono::duration<double, std::nano>(t2 - t1).count() / words.size());
+  }
+  if (sink != 2 * runs * hits)
+    return 1;
+
+  const size_t index = table->get_index_memory();
+  printf("%s: %zu lookups, %zu hits | index %.1f ns, chains %.1f ns | heap %.2f MB, of it index and Bloom filter %.2f MB, chains alone %.2f MB\n",
+         base.c_str(), words.size(), hits, index_ns, chain_ns, heap / 1048576.0, index / 1048576.0,
+         (heap - index) / 1048576.0);
+  delete table;
+  return 0;
+}
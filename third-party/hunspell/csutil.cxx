@@ -70,6 +70,7 @@
 
 #include <algorithm>
 #include <assert.h>
+#include <bitset>
 #include <cstdlib>
 #include <cstring>
 #include <cstdio>
@@ -97,6 +98,15 @@
 #endif
 #endif
 
+// HUNSPELL_NO_SSE2 keeps the scalar ASCII branches only (bench/casebench-scalar)
+#if !defined(HUNSPELL_NO_SSE2) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define HUNSPELL_SSE2
+#include <emmintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
 #ifdef MOZILLA_CLIENT
 #include "nsCOMPtr.h"
 #include "nsUnicharUtils.h"
@@ -127,6 +137,80 @@ void myopen(std::ifstream& stream, const char* path, std::ios_base::openmode mod
 }
 #endif
 
+#ifdef HUNSPELL_SSE2
+// SSE2 fast paths for ASCII text in the UTF-8 conversion, case type and case
+// mapping functions below. While the text is ASCII they take 16 or 8 bytes,
+// or 8 or 4 w_char as 16-bit lanes (w_char is little endian), at a time.
+// Loads and stores never go past the strings, a tail shorter than a block
+// goes through the scalar code, which also skips the tables for ASCII.
+namespace {
+// the 8 (block >= 8) or 4 w_char at p as 16-bit lanes, the others 0
+inline __m128i load_wchars(const w_char* p, size_t block) {
+  if (block >= 8)
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+  return _mm_loadl_epi64(reinterpret_cast<const __m128i*>(p));
+}
+
+inline void store_wchars(w_char* p, __m128i v, size_t block) {
+  if (block >= 8)
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v);
+  else
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(p), v);
+}
+
+inline int lowest_bit(unsigned mask) {
+#if defined(_MSC_VER) && !defined(__clang__)
+  unsigned long index;
+  _BitScanForward(&index, mask);
+  return static_cast<int>(index);
+#else
+  return __builtin_ctz(mask);
+#endif
+}
+
+// number of leading bytes of v below 0x80, at most n
+inline size_t ascii_bytes(__m128i v, size_t n) {
+  const unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(v)) | 0x10000;
+  return std::min<size_t>(lowest_bit(mask), n);
+}
+
+// number of leading w_char lanes of v below 0x80, at most n
+inline size_t ascii_wchars(__m128i v, size_t n) {
+  const __m128i high = _mm_and_si128(v, _mm_set1_epi16(static_cast<short>(0xff80)));
+  const unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi16(high, _mm_setzero_si128())));
+  return std::min<size_t>(lowest_bit(~mask) / 2, n);
+}
+
+// all ones in the w_char lanes of v from first to last
+inline __m128i wchars_in_range(__m128i v, char first, char last) {
+  return _mm_and_si128(_mm_cmpgt_epi16(v, _mm_set1_epi16(first - 1)),
+                       _mm_cmplt_epi16(v, _mm_set1_epi16(last + 1)));
+}
+
+// number of the first n lanes set in a wchars_in_range() result
+inline size_t count_wchars(__m128i lanes, size_t n) {
+  const unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(lanes)) & ((1u << (2 * n)) - 1);
+  return std::bitset<16>(mask).count() / 2;
+}
+
+// v with the ASCII letters of the other case moved to upper or lower case,
+// other characters are left unchanged
+inline __m128i ascii_case(__m128i v, bool upper) {
+  if (upper)
+    return _mm_sub_epi16(v, _mm_and_si128(wchars_in_range(v, 'a', 'z'), _mm_set1_epi16(0x20)));
+  return _mm_add_epi16(v, _mm_and_si128(wchars_in_range(v, 'A', 'Z'), _mm_set1_epi16(0x20)));
+}
+}
+#endif
+
+namespace {
+// the tables map ASCII letters to each other, except I and i in the
+// languages with a dotted and dotless i
+inline bool ascii_case_mapping(int langnum) {
+  return langnum != LANG_az && langnum != LANG_tr && langnum != LANG_crh;
+}
+}
+
 // Encode a BMP-only sequence of w_char codepoints as UTF-8.
 // Each w_char represents a single 16-bit codepoint (h:l). Codepoints
 // outside the BMP are not representable here and never produced by
@@ -134,9 +218,23 @@ void myopen(std::ifstream& stream, const char* path, std::ios_base::openmode mod
 std::string& u16_u8(std::string& dest, const std::vector<w_char>& src) {
   dest.clear();
   dest.reserve(src.size());
-  for (const w_char& wc : src) {
+  for (size_t i = 0; i < src.size(); ++i) {
+    const w_char& wc = src[i];
     uint16_t cp = (static_cast<uint16_t>(wc.h) << 8) | wc.l;
     if (cp < 0x80) {
+#ifdef HUNSPELL_SSE2
+      if (src.size() - i >= 4) {
+        // this and the ASCII characters following it, narrowed to bytes
+        const size_t block = src.size() - i >= 8 ? 8 : 4;
+        const __m128i v = load_wchars(&src[i], block);
+        const size_t ascii = ascii_wchars(v, block);
+        alignas(16) char buf[16];
+        _mm_store_si128(reinterpret_cast<__m128i*>(buf), _mm_packus_epi16(v, v));
+        dest.append(buf, ascii);
+        i += ascii - 1;
+        continue;
+      }
+#endif
       dest.push_back(static_cast<char>(cp));
     } else if (cp < 0x800) {
       dest.push_back(static_cast<char>(0xc0 | (cp >> 6)));
@@ -179,6 +277,22 @@ int u8_u16(std::vector<w_char>& dest, const std::string& src, bool only_convert_
 
     if (b0 < 0x80) {
       // 1-byte ASCII
+#ifdef HUNSPELL_SSE2
+      if (!only_convert_first_letter && end - p >= 8) {
+        // this and the ASCII bytes following it, widened to w_char
+        const size_t block = end - p >= 16 ? 16 : 8;
+        const __m128i v = block == 16 ? _mm_loadu_si128(reinterpret_cast<const __m128i*>(&*p))
+                                      : _mm_loadl_epi64(reinterpret_cast<const __m128i*>(&*p));
+        const size_t ascii = ascii_bytes(v, block);
+        const __m128i zero = _mm_setzero_si128();
+        store_wchars(&*out, _mm_unpacklo_epi8(v, zero), 8);
+        if (ascii > 8)
+          store_wchars(&*out + 8, _mm_unpackhi_epi8(v, zero), 8);
+        out += ascii;
+        p += ascii;
+        continue;
+      }
+#endif
       cp = b0;
     } else if (b0 < 0xc0) {
       // continuation byte at lead position
@@ -592,15 +706,53 @@ std::string& mkallsmall(std::string& s, const struct cs_info* csconv) {
 }
 
 std::vector<w_char>& mkallsmall_utf(std::vector<w_char>& u, int langnum) {
-  for (auto& i : u) {
-    i = lower_utf(i, langnum);
+  const bool ascii_lower = ascii_case_mapping(langnum);
+  size_t i = 0;
+#ifdef HUNSPELL_SSE2
+  // leading ASCII characters
+  while (ascii_lower && u.size() - i >= 4) {
+    const size_t block = u.size() - i >= 8 ? 8 : 4;
+    const __m128i v = load_wchars(&u[i], block);
+    const size_t ascii = ascii_wchars(v, block);
+    store_wchars(&u[i], ascii_case(v, false), block);
+    i += ascii;
+    if (ascii < block)
+      break;
+  }
+#endif
+  for (; i < u.size(); ++i) {
+    if (ascii_lower && u[i] < 0x80) {
+      if (u[i].l >= 'A' && u[i].l <= 'Z')
+        u[i].l += 'a' - 'A';
+    } else {
+      u[i] = lower_utf(u[i], langnum);
+    }
   }
   return u;
 }
 
 std::vector<w_char>& mkallcap_utf(std::vector<w_char>& u, int langnum) {
-  for (auto& i : u) {
-    i = upper_utf(i, langnum);
+  const bool ascii_upper = ascii_case_mapping(langnum);
+  size_t i = 0;
+#ifdef HUNSPELL_SSE2
+  // leading ASCII characters
+  while (ascii_upper && u.size() - i >= 4) {
+    const size_t block = u.size() - i >= 8 ? 8 : 4;
+    const __m128i v = load_wchars(&u[i], block);
+    const size_t ascii = ascii_wchars(v, block);
+    store_wchars(&u[i], ascii_case(v, true), block);
+    i += ascii;
+    if (ascii < block)
+      break;
+  }
+#endif
+  for (; i < u.size(); ++i) {
+    if (ascii_upper && u[i] < 0x80) {
+      if (u[i].l >= 'a' && u[i].l <= 'z')
+        u[i].l -= 'a' - 'A';
+    } else {
+      u[i] = upper_utf(u[i], langnum);
+    }
   }
   return u;
 }
@@ -2534,8 +2686,33 @@ int get_captype_utf8(const std::vector<w_char>& word, int langnum) {
   size_t firstcap = 0;
 
   auto it = word.begin(), it_end = word.end();
+#ifdef HUNSPELL_SSE2
+  // leading ASCII characters: A-Z are capitals and everything but letters
+  // is neutral, in every language
+  while (it_end - it >= 4) {
+    const size_t block = it_end - it >= 8 ? 8 : 4;
+    const __m128i v = load_wchars(&*it, block);
+    const size_t ascii = ascii_wchars(v, block);
+    const __m128i upper = wchars_in_range(v, 'A', 'Z');
+    const __m128i letter = _mm_or_si128(upper, wchars_in_range(v, 'a', 'z'));
+    ncap += count_wchars(upper, ascii);
+    nneutral += ascii - count_wchars(letter, ascii);
+    it += ascii;
+    if (ascii < block)
+      break;
+  }
+#endif
   while (it != it_end) {
     const auto idx = (unsigned short)*it;
+    if (idx < 0x80) {
+      // ASCII, as above
+      if (idx >= 'A' && idx <= 'Z')
+        ncap++;
+      else if (idx < 'a' || idx > 'z')
+        nneutral++;
+      ++it;
+      continue;
+    }
     const auto lwridx = unicodetolower(idx, langnum);
     if (idx != lwridx)
       ncap++;
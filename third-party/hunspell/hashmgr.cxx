@@ -75,9 +75,15 @@
 #include <cstring>
 #include <cstdio>
 #include <cctype>
+#include <cstdint>
+#include <exception>
+#include <fstream>
+#include <iterator>
 #include <limits>
 #include <sstream>
+#include <thread>
 #include <type_traits>
+#include <unordered_map>
 #if __cplusplus >= 202002L || (defined(_MSVC_LANG) && _MSVC_LANG >= 202002L)
 #include <bit>
 #endif
@@ -87,6 +93,135 @@
 #include "atypes.hxx"
 #include "langnum.hxx"
 
+namespace {
+
+// smallest share of .dic lines worth a load_tables thread of its own
+const size_t LOAD_THREAD_MIN_LINES = 16384;
+
+// hash of the lookup index: 8 bytes at a time, multiply and xorshift
+// (splitmix64 constants), every input bit reaches the slot and the key bits
+inline uint64_t index_hash(const char* word, size_t len) {
+  uint64_t h = 0x9E3779B97F4A7C15ULL ^ len;
+  uint64_t v;
+  for (; len >= 8; word += 8, len -= 8) {
+    memcpy(&v, word, 8);
+    h = (h ^ v) * 0xBF58476D1CE4E5B9ULL;
+    h ^= h >> 29;
+  }
+  v = 0;
+  memcpy(&v, word, len);
+  h = (h ^ v) * 0x94D049BB133111EBULL;
+  h ^= h >> 32;
+  h *= 0xBF58476D1CE4E5B9ULL;
+  return h ^ (h >> 29);
+}
+
+// slot key: 24 bits of the hash the slot index did not use, and the low byte
+// of the word length, so most mismatches never touch the hentry; 0 is free
+inline uint32_t index_key(uint64_t hv, size_t len) {
+  uint32_t key = static_cast<uint32_t>(hv >> 40) << 8 | static_cast<uint32_t>(len & 0xff);
+  return key ? key : 0x100;
+}
+
+// a word sets BLOOM_PROBES bits of one 8 word (512 bit) block of the Bloom
+// filter; the block comes from the hash, the bits 9 at a time from the high
+// half of a remix of it
+const int BLOOM_PROBES = 6;
+
+inline size_t bloom_block(uint64_t hv, size_t words) {
+  return ((hv >> 16) & (words / 8 - 1)) * 8;
+}
+
+inline uint64_t bloom_bits(uint64_t hv) {
+  return (hv * 0xD6E8FEB86659FD93ULL) >> 10;
+}
+
+// Binary dictionary image, see HashMgr::save_image. After the header: the
+// strings (encoding, language, IGNORE, REP table), flag vectors, the AF and AM
+// alias tables, the bucket array and the hentry records, each laid out as in
+// memory. Pointers are stored as (offset in the file + 1), 0 for null, and
+// turned back into pointers once when loading.
+const char IMAGE_MAGIC[8] = {'H', 'U', 'N', 'I', 'M', 'G', '\r', '\n'};
+const uint32_t IMAGE_VERSION = 1;
+const uint32_t IMAGE_ENDIAN = 0x01020304;
+
+struct ImageHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t endian;
+  uint32_t pointer_size;
+  uint32_t hentry_size;
+  uint64_t total_size;
+  int32_t flag_mode;
+  int32_t complexprefixes;
+  int32_t utf8;
+  int32_t langnum;
+  uint32_t forbiddenword;
+  uint32_t reserved;
+  uint64_t table_size;
+  uint64_t entry_count;
+  uint64_t aliasf_count;
+  uint64_t aliasm_count;
+  uint64_t strings_offset;
+  uint64_t aliasf_offset;  // aliasf_count x (flags ref, length)
+  uint64_t aliasm_offset;  // aliasm_count x string ref
+  uint64_t buckets_offset; // table_size x entry ref
+  uint64_t entries_offset;
+  uint64_t entries_end;
+};
+
+bool image_header_ok(const ImageHeader& h, uint64_t file_size) {
+  return memcmp(h.magic, IMAGE_MAGIC, sizeof(IMAGE_MAGIC)) == 0 &&
+         h.version == IMAGE_VERSION && h.endian == IMAGE_ENDIAN &&
+         h.pointer_size == sizeof(void*) && h.hentry_size == sizeof(hentry) &&
+         h.total_size == file_size && h.table_size > 0 &&
+         h.strings_offset <= file_size && h.aliasf_offset <= file_size &&
+         h.aliasm_offset <= file_size && h.buckets_offset <= file_size &&
+         h.table_size <= (file_size - h.buckets_offset) / sizeof(uint64_t) &&
+         h.entries_offset % alignof(hentry) == 0 &&
+         h.entries_offset <= h.entries_end && h.entries_end <= file_size;
+}
+
+// allocation size of a record, as add_word makes it
+size_t hentry_alloc_size(const hentry* hp) {
+  size_t descl = 0;
+  if (hp->var & H_OPT)
+    descl = (hp->var & H_OPT_ALIASM) ? sizeof(char*) : strlen(HENTRY_WORD(hp) + hp->blen + 1) + 1;
+  return sizeof(hentry) + hp->blen + descl;
+}
+
+// space of a record in the image, the next one stays aligned
+size_t hentry_record_size(const hentry* hp) {
+  return (hentry_alloc_size(hp) + alignof(hentry) - 1) & ~(alignof(hentry) - 1);
+}
+
+// hentry_record_size of a record in an image, reading nothing past avail
+// bytes: 0 if the word, its terminator or the description do not fit
+size_t image_record_size(const hentry* hp, size_t avail) {
+  const size_t word = offsetof(hentry, word);
+  if (avail < sizeof(hentry) || avail - sizeof(hentry) < hp->blen || hp->word[hp->blen] != '\0')
+    return 0;
+  size_t descl = 0;
+  if ((hp->var & H_OPT) && (hp->var & H_OPT_ALIASM)) {
+    descl = sizeof(char*);
+  } else if (hp->var & H_OPT) {
+    const char* desc = HENTRY_WORD(hp) + hp->blen + 1;
+    const void* end = memchr(desc, '\0', avail - (word + hp->blen + 1));
+    if (!end)
+      return 0;
+    descl = static_cast<const char*>(end) - desc + 1;
+  }
+  size_t size = (sizeof(hentry) + hp->blen + descl + alignof(hentry) - 1) & ~(alignof(hentry) - 1);
+  return size <= avail ? size : 0;
+}
+
+template <typename T>
+T* ref_to_pointer(uint64_t ref) {
+  return reinterpret_cast<T*>(static_cast<uintptr_t>(ref));
+}
+
+}
+
 // build a hash table from a munched word list
 
 HashMgr::HashMgr(const char* tpath, const char* apath, const char* key)
@@ -96,10 +231,18 @@ HashMgr::HashMgr(const char* tpath, const char* apath, const char* key)
     , forbiddenword(FORBIDDENWORD)  // forbidden word signing flag
     , langnum(0)
     , csconv(nullptr) {
-  load_config(apath, key);
-  if (!csconv)
-    csconv = get_current_cs(SPELL_ENCODING);
-  int ec = load_tables(tpath, key);
+  int ec;
+  if (!key && is_image(tpath)) {
+    // everything load_config and load_tables would build, ready made
+    ec = load_image(tpath);
+    if (!csconv)
+      csconv = get_current_cs(SPELL_ENCODING);
+  } else {
+    load_config(apath, key);
+    if (!csconv)
+      csconv = get_current_cs(SPELL_ENCODING);
+    ec = load_tables(tpath, key);
+  }
   if (ec) {
     /* error condition - what should we do here */
     fprintf(stderr, "Hash Manager Error : %d\n", ec);
@@ -109,7 +252,7 @@ HashMgr::HashMgr(const char* tpath, const char* apath, const char* key)
   }
 }
 
-void HashMgr::release_flags(unsigned short* astr, bool owned) {
+void HashMgr::release_flags(unsigned short* astr, bool owned) const {
   if (owned)
     delete[] astr;
 }
@@ -127,6 +270,10 @@ void HashMgr::free_table() {
     }
   }
   tableptr.clear();
+  index_keys.clear();
+  index_entries.clear();
+  index_count = 0;
+  bloom.clear();
 }
 
 HashMgr::~HashMgr() {
@@ -152,14 +299,88 @@ HashMgr::~HashMgr() {
 // lookup a root word in the hashtable
 
 struct hentry* HashMgr::lookup(const char* word, size_t len) const {
-  struct hentry* dp = tableptr[hash(word, len)];
-  if (!dp)
+  if (index_keys.empty())
     return nullptr;
-  for (; dp != nullptr; dp = dp->next) {
-    if (strcmp(word, dp->word) == 0)
-      return dp;
+  ++lookup_count;
+  uint64_t hv = index_hash(word, len);
+  const uint64_t* block = &bloom[bloom_block(hv, bloom.size())];
+  uint64_t bits = bloom_bits(hv);
+  for (int probe = 0; probe < BLOOM_PROBES; ++probe, bits >>= 9) {
+    if (!(block[(bits >> 6) & 7] & (1ULL << (bits & 63)))) {
+      ++bloom_rejects;
+      ++lookup_misses;
+      return nullptr;
+    }
+  }
+  uint32_t key = index_key(hv, len);
+  size_t mask = index_keys.size() - 1;
+  for (size_t i = hv & mask;; i = (i + 1) & mask) {
+    uint32_t k = index_keys[i];
+    if (k == key) {
+      struct hentry* dp = index_entries[i];
+      if (dp->blen == len && memcmp(word, dp->word, len) == 0)
+        return dp;
+    } else if (k == 0) {
+      ++lookup_misses;
+      return nullptr;
+    }
   }
-  return nullptr;
+}
+
+void HashMgr::lookup_stats(size_t* lookups, size_t* misses, size_t* rejected) const {
+  *lookups = lookup_count;
+  *misses = lookup_misses;
+  *rejected = bloom_rejects;
+}
+
+size_t HashMgr::get_index_memory() const {
+  return index_keys.capacity() * sizeof(uint32_t) +
+         index_entries.capacity() * sizeof(struct hentry*) +
+         bloom.capacity() * sizeof(uint64_t);
+}
+
+// room for this many distinct words without growing, at most 3/4 full
+void HashMgr::index_reserve(size_t words) {
+  size_t size = 16;
+  while (size * 3 / 4 < words)
+    size *= 2;
+  if (size <= index_keys.size())
+    return;
+
+  std::vector<uint32_t> keys(size, 0);
+  std::vector<struct hentry*> entries(size, nullptr);
+  keys.swap(index_keys);
+  entries.swap(index_entries);
+  index_count = 0;
+  bloom.assign(std::max<size_t>(size / 8, 8), 0);
+  for (size_t i = 0; i < keys.size(); ++i) {
+    if (keys[i])
+      index_insert(entries[i]);
+  }
+}
+
+// make hp the entry lookup finds for its word, unless the word has one: the
+// first entry linked for a word stays the head of its homonyms
+void HashMgr::index_insert(struct hentry* hp) {
+  if ((index_count + 1) * 4 > index_keys.size() * 3)
+    index_reserve(index_count + 1);
+  uint64_t hv = index_hash(hp->word, hp->blen);
+  uint32_t key = index_key(hv, hp->blen);
+  size_t mask = index_keys.size() - 1;
+  size_t i = hv & mask;
+  for (; index_keys[i]; i = (i + 1) & mask) {
+    if (index_keys[i] == key && index_entries[i]->blen == hp->blen &&
+        memcmp(index_entries[i]->word, hp->word, hp->blen) == 0)
+      return;
+  }
+  index_keys[i] = key;
+  index_entries[i] = hp;
+  ++index_count;
+
+  uint64_t* block = &bloom[bloom_block(hv, bloom.size())];
+  uint64_t bits = bloom_bits(hv);
+  for (int probe = 0; probe < BLOOM_PROBES; ++probe, bits >>= 9)
+    block[(bits >> 6) & 7] |= 1ULL << (bits & 63);
 }
 
 // add a word to the hash table (private)
@@ -171,6 +392,28 @@ int HashMgr::add_word(const std::string& in_word,
                       bool onlyupcase,
                       int captype,
                       bool own_aff) {
+  struct hentry* hp;
+  int bucket;
+  if (make_entry(in_word, wcl, aff, al, in_desc, captype, own_aff, arena, reptable, &hp, &bucket))
+    return 1;
+  if (link_entry(hp, bucket, onlyupcase))
+    added.push_back(hp);
+  return 0;
+}
+
+// build the hash record of a word; reads only the .aff settings, so the
+// load_tables threads can run it side by side
+int HashMgr::make_entry(const std::string& in_word,
+                        int wcl,
+                        unsigned short* aff,
+                        int al,
+                        const std::string* in_desc,
+                        int captype,
+                        bool own_aff,
+                        Arena& entry_arena,
+                        std::vector<replentry>& reps,
+                        struct hentry** entry,
+                        int* bucket) const {
 
   if (al > std::numeric_limits<short>::max()) {
     HUNSPELL_WARNING(stderr, "error: affix len %d is over max limit\n", al);
@@ -225,12 +468,11 @@ int HashMgr::add_word(const std::string& in_word,
     return 1;
   }
 
-  bool upcasehomonym = false;
   int descl = desc ? (!aliasm.empty() ? sizeof(char*) : desc->size() + 1) : 0;
   // variable-length hash record with word and optional fields
   auto hp =
-      (struct hentry*)arena_alloc(sizeof(struct hentry) + word->size() + descl,
-                                  alignof(struct hentry));
+      (struct hentry*)entry_arena.alloc(sizeof(struct hentry) + word->size() + descl,
+                                        alignof(struct hentry));
   if (!hp) {
     delete desc_copy;
     delete word_copy;
@@ -242,7 +484,7 @@ int HashMgr::add_word(const std::string& in_word,
   memcpy(hpw, word->data(), word->size());
   hpw[word->size()] = 0;
 
-  int i = hash(hpw, word->size());
+  *bucket = hash(hpw, word->size());
 
   hp->blen = (unsigned short)word->size();
   hp->clen = (unsigned short)wcl;
@@ -268,8 +510,8 @@ int HashMgr::add_word(const std::string& in_word,
       // store ph: fields (pronounciation, misspellings, old orthography etc.)
       // of a morphological description in reptable to use in REP replacements.
       size_t predicted = tableptr.size() / MORPH_PHON_RATIO;
-      if (reptable.capacity() < predicted)
-          reptable.reserve(predicted);
+      if (reps.capacity() < predicted)
+          reps.reserve(predicted);
       std::string fields = HENTRY_DATA(hp);
       std::string::const_iterator iter = fields.begin(), start_piece = mystrsep(fields, iter);
       while (start_piece != fields.end()) {
@@ -347,18 +589,18 @@ int HashMgr::add_word(const std::string& in_word,
                   } else {
                     mkallsmall(wordpart_lower, csconv);
                   }
-                  reptable.emplace_back();
-                  reptable.back().pattern.assign(ph);
-                  reptable.back().outstrings[0].assign(wordpart_lower);
+                  reps.emplace_back();
+                  reps.back().pattern.assign(ph);
+                  reps.back().outstrings[0].assign(wordpart_lower);
                 }
-                reptable.emplace_back();
-                reptable.back().pattern.assign(ph_capitalized);
-                reptable.back().outstrings[0].assign(wordpart);
+                reps.emplace_back();
+                reps.back().pattern.assign(ph_capitalized);
+                reps.back().outstrings[0].assign(wordpart);
               }
             }
-            reptable.emplace_back();
-            reptable.back().pattern.assign(ph);
-            reptable.back().outstrings[0].assign(wordpart);
+            reps.emplace_back();
+            reps.back().pattern.assign(ph);
+            reps.back().outstrings[0].assign(wordpart);
           }
         }
         start_piece = mystrsep(fields, iter);
@@ -366,12 +608,21 @@ int HashMgr::add_word(const std::string& in_word,
     }
   }
 
-  struct hentry* dp = tableptr[i];
+  delete desc_copy;
+  delete word_copy;
+  *entry = hp;
+  return 0;
+}
+
+// put a record made by make_entry in its bucket, after the words already there;
+// false when it was merged into an entry of the same word and released
+bool HashMgr::link_entry(struct hentry* hp, int bucket, bool onlyupcase) {
+  bool upcasehomonym = false;
+  struct hentry* dp = tableptr[bucket];
   if (!dp) {
-    tableptr[i] = hp;
-    delete desc_copy;
-    delete word_copy;
-    return 0;
+    tableptr[bucket] = hp;
+    index_insert(hp);
+    return true;
   }
   while (dp->next != nullptr) {
     if ((!dp->next_homonym) && (strcmp(hp->word, dp->word) == 0)) {
@@ -384,17 +635,13 @@ int HashMgr::add_word(const std::string& in_word,
           dp->var &= ~H_OPT_OWNFLAGS;
           dp->var |= (hp->var & H_OPT_OWNFLAGS);
           arena_free(hp);
-          delete desc_copy;
-          delete word_copy;
-          return 0;
+          return false;
         } else if (!dp->astr && dp->alen == 0 &&
                    !hp->astr && hp->alen == 0) {
           // word already exists with no flags, skip duplicate
           release_flags(hp->astr, hp->var & H_OPT_OWNFLAGS);
           arena_free(hp);
-          delete desc_copy;
-          delete word_copy;
-          return 0;
+          return false;
         } else {
           dp->next_homonym = hp;
         }
@@ -414,17 +661,13 @@ int HashMgr::add_word(const std::string& in_word,
         dp->var &= ~H_OPT_OWNFLAGS;
         dp->var |= (hp->var & H_OPT_OWNFLAGS);
         arena_free(hp);
-        delete desc_copy;
-        delete word_copy;
-        return 0;
+        return false;
       } else if (!dp->astr && dp->alen == 0 &&
                  !hp->astr && hp->alen == 0) {
         // word already exists with no flags, skip duplicate
         release_flags(hp->astr, hp->var & H_OPT_OWNFLAGS);
         arena_free(hp);
-        delete desc_copy;
-        delete word_copy;
-        return 0;
+        return false;
       } else {
         dp->next_homonym = hp;
       }
@@ -434,23 +677,42 @@ int HashMgr::add_word(const std::string& in_word,
   }
   if (!upcasehomonym) {
     dp->next = hp;
-  } else {
-    // remove hidden onlyupcase homonym
-    release_flags(hp->astr, hp->var & H_OPT_OWNFLAGS);
-    arena_free(hp);
+    index_insert(hp);
+    return true;
   }
-
-  delete desc_copy;
-  delete word_copy;
-  return 0;
+  // remove hidden onlyupcase homonym
+  release_flags(hp->astr, hp->var & H_OPT_OWNFLAGS);
+  arena_free(hp);
+  return false;
 }
 
+
 int HashMgr::add_hidden_capitalized_word(const std::string& word,
                                          int wcl,
                                          unsigned short* flags,
                                          int flagslen,
                                          const std::string* dp,
                                          int captype) {
+  struct hentry* hp;
+  int bucket;
+  if (make_hidden_capitalized_entry(word, wcl, flags, flagslen, dp, captype, arena, reptable, &hp, &bucket))
+    return 1;
+  if (hp && link_entry(hp, bucket, true))
+    added.push_back(hp);
+  return 0;
+}
+
+int HashMgr::make_hidden_capitalized_entry(const std::string& word,
+                                           int wcl,
+                                           unsigned short* flags,
+                                           int flagslen,
+                                           const std::string* dp,
+                                           int captype,
+                                           Arena& entry_arena,
+                                           std::vector<replentry>& reps,
+                                           struct hentry** hp,
+                                           int* bucket) const {
+  *hp = nullptr;
   if (flags == nullptr)
     flagslen = 0;
 
@@ -460,8 +722,8 @@ int HashMgr::add_hidden_capitalized_word(const std::string& word,
   if (((captype == HUHCAP) || (captype == HUHINITCAP) ||
        ((captype == ALLCAP) && (flagslen != 0))) &&
       !((flagslen != 0) && TESTAFF(flags, forbiddenword, flagslen))) {
-    auto flags2 = (unsigned short*)arena_alloc((flagslen + 1) * sizeof(unsigned short),
-                                                alignof(unsigned short));
+    auto flags2 = (unsigned short*)entry_arena.alloc((flagslen + 1) * sizeof(unsigned short),
+                                                      alignof(unsigned short));
     flags2[flagslen] = ONLYUPCASEFLAG;
     if (flagslen) {
       memcpy(flags2, flags, flagslen * sizeof(unsigned short));
@@ -474,20 +736,19 @@ int HashMgr::add_hidden_capitalized_word(const std::string& word,
       mkallsmall_utf(w, langnum);
       mkinitcap_utf(w, langnum);
       u16_u8(st, w);
-      return add_word(st, wcl, flags2, flagslen + 1, dp, true, INITCAP, false);
+      return make_entry(st, wcl, flags2, flagslen + 1, dp, INITCAP, false, entry_arena, reps, hp, bucket);
     } else {
       std::string new_word(word);
       mkallsmall(new_word, csconv);
       mkinitcap(new_word, csconv);
-      int ret = add_word(new_word, wcl, flags2, flagslen + 1, dp, true, INITCAP, false);
-      return ret;
+      return make_entry(new_word, wcl, flags2, flagslen + 1, dp, INITCAP, false, entry_arena, reps, hp, bucket);
     }
   }
   return 0;
 }
 
 // detect captype and modify word length for UTF-8 encoding
-int HashMgr::get_clen_and_captype(const std::string& word, int* captype, std::vector<w_char> &workbuf) {
+int HashMgr::get_clen_and_captype(const std::string& word, int* captype, std::vector<w_char> &workbuf) const {
   int len;
   if (utf8) {
     len = u8_u16(workbuf, word);
@@ -499,7 +760,7 @@ int HashMgr::get_clen_and_captype(const std::string& word, int* captype, std::ve
   return len;
 }
 
-int HashMgr::get_clen_and_captype(const std::string& word, int* captype) {
+int HashMgr::get_clen_and_captype(const std::string& word, int* captype) const {
   std::vector<w_char> workbuf;
   return get_clen_and_captype(word, captype, workbuf);
 }
@@ -605,6 +866,10 @@ struct hentry* HashMgr::walk_hashtable(int& col, struct hentry* hp) const {
   return nullptr;
 }
 
+const std::vector<struct hentry*>& HashMgr::get_added() const {
+  return added;
+}
+
 // load a munched word list and build a hash table on the fly
 int HashMgr::load_tables(const char* tpath, const char* key) {
   // open dictionary file
@@ -648,11 +913,12 @@ int HashMgr::load_tables(const char* tpath, const char* key) {
   // allocate the hash table
   tableptr.resize(tablesize, nullptr);
 
-  // loop through all words on much list and add to hash
-  // table and create word and affix strings
-
-  std::vector<w_char> workbuf;
-
+  // read the word list up front, then build the entries of contiguous line
+  // ranges side by side; they are linked into the table in file order
+  // afterwards, so chains and homonyms come out as a line by line load
+  // would leave them
+  std::string text;
+  std::vector<size_t> starts;
   int nLineCount(0);
   while (dict->getline(ts)) {
     ++nLineCount;
@@ -661,100 +927,509 @@ int HashMgr::load_tables(const char* tpath, const char* key) {
     if (nLineCount >= tablesize)
       break;
 #endif
-    mychomp(ts);
-    // split each line into word and morphological description
-    size_t dp_pos = 0;
-    while ((dp_pos = ts.find(':', dp_pos)) != std::string::npos) {
-      if ((dp_pos > 3) && (ts[dp_pos - 3] == ' ' || ts[dp_pos - 3] == '\t')) {
-        for (dp_pos -= 3; dp_pos > 0 && (ts[dp_pos-1] == ' ' || ts[dp_pos-1] == '\t'); --dp_pos)
-          ;
-        if (dp_pos == 0) {  // missing word
-          dp_pos = std::string::npos;
-        } else {
-          ++dp_pos;
-        }
-        break;
+    starts.push_back(text.size());
+    text.append(ts);
+  }
+  starts.push_back(text.size());
+  delete dict;
+
+  const size_t nlines = starts.size() - 1;
+  size_t nthreads = std::thread::hardware_concurrency();
+  nthreads = std::min<size_t>(nthreads, HUNSPELL_LOAD_THREADS);
+  nthreads = std::min<size_t>(nthreads, nlines / LOAD_THREAD_MIN_LINES);
+  nthreads = std::max<size_t>(nthreads, 1);
+
+  std::vector<DicChunk> chunks(nthreads);
+  std::vector<std::exception_ptr> failures(nthreads);
+  auto parse = [&](size_t c) {
+    try {
+      std::vector<w_char> workbuf;
+      std::string line;
+      for (size_t l = nlines * c / nthreads, end = nlines * (c + 1) / nthreads;
+           l < end && !chunks[c].error; ++l) {
+        line.assign(text, starts[l], starts[l + 1] - starts[l]);
+        chunks[c].error = parse_dic_line(line, int(l) + 2, chunks[c], workbuf);
       }
-      ++dp_pos;
+    } catch (...) {
+      failures[c] = std::current_exception();
     }
+  };
+  std::vector<std::thread> threads;
+  for (size_t c = 1; c < nthreads; ++c)
+    threads.emplace_back(parse, c);
+  parse(0);
+  for (auto& thread : threads)
+    thread.join();
+  for (auto& failure : failures) {
+    if (failure)
+      std::rethrow_exception(failure);
+  }
 
-    // tabulator is the old morphological field separator
-    size_t dp2_pos = ts.find('\t');
-    if (dp2_pos != std::string::npos && (dp_pos == std::string::npos || dp2_pos < dp_pos)) {
-      dp_pos = dp2_pos + 1;
-    }
+  size_t nentries = 0;
+  for (const auto& chunk : chunks)
+    nentries += chunk.entries.size();
+  index_reserve(nentries);
+  for (auto& chunk : chunks) {
+    arena.adopt(chunk.arena);
+    for (const auto& entry : chunk.entries)
+      link_entry(entry.hp, entry.bucket, entry.onlyupcase);
+    reptable.insert(reptable.end(), std::make_move_iterator(chunk.reptable.begin()),
+                    std::make_move_iterator(chunk.reptable.end()));
+    // entries of the lines before the failing one are in, as before
+    if (chunk.error)
+      return chunk.error;
+  }
+
+  int ret(0);
 
-    std::string dp;
-    if (dp_pos != std::string::npos) {
-      dp.assign(ts.substr(dp_pos));
-      ts.resize(dp_pos - 1);
+  // reject ludicrous tablesizes
+  if (tablesize > 8192 + nExtra && tablesize > nLineCount * 10 + nExtra) {
+    HUNSPELL_WARNING(stderr, ".dic initial approximate word count line value of %d is too large for %d lines\n", tablesize, nLineCount);
+    ret = 3;
+  }
+
+  return ret;
+}
+
+// split a .dic line into word, flags and description and build its entries
+// (the word and its hidden capitalized form) into chunk; runs on the
+// load_tables threads, so it only reads the settings of the .aff file
+int HashMgr::parse_dic_line(std::string& ts, int linenum, DicChunk& chunk, std::vector<w_char>& workbuf) const {
+  mychomp(ts);
+  // split each line into word and morphological description
+  size_t dp_pos = 0;
+  while ((dp_pos = ts.find(':', dp_pos)) != std::string::npos) {
+    if ((dp_pos > 3) && (ts[dp_pos - 3] == ' ' || ts[dp_pos - 3] == '\t')) {
+      for (dp_pos -= 3; dp_pos > 0 && (ts[dp_pos-1] == ' ' || ts[dp_pos-1] == '\t'); --dp_pos)
+        ;
+      if (dp_pos == 0) {  // missing word
+        dp_pos = std::string::npos;
+      } else {
+        ++dp_pos;
+      }
+      break;
     }
+    ++dp_pos;
+  }
 
-    // split each line into word and affix char strings
-    // "\/" signs slash in words (not affix separator)
-    // "/" at beginning of the line is word character (not affix separator)
-    size_t ap_pos = ts.find('/');
-    while (ap_pos != std::string::npos) {
-      if (ap_pos == 0) {
-        ++ap_pos;
-        ap_pos = ts.find('/', ap_pos);
-        continue;
-      } else if (ts[ap_pos - 1] != '\\')
-        break;
-      // replace "\/" with "/"
-      ts.erase(ap_pos - 1, 1);
+  // tabulator is the old morphological field separator
+  size_t dp2_pos = ts.find('\t');
+  if (dp2_pos != std::string::npos && (dp_pos == std::string::npos || dp2_pos < dp_pos)) {
+    dp_pos = dp2_pos + 1;
+  }
+
+  std::string dp;
+  if (dp_pos != std::string::npos) {
+    dp.assign(ts.substr(dp_pos));
+    ts.resize(dp_pos - 1);
+  }
+
+  // split each line into word and affix char strings
+  // "\/" signs slash in words (not affix separator)
+  // "/" at beginning of the line is word character (not affix separator)
+  size_t ap_pos = ts.find('/');
+  while (ap_pos != std::string::npos) {
+    if (ap_pos == 0) {
+      ++ap_pos;
       ap_pos = ts.find('/', ap_pos);
-    }
+      continue;
+    } else if (ts[ap_pos - 1] != '\\')
+      break;
+    // replace "\/" with "/"
+    ts.erase(ap_pos - 1, 1);
+    ap_pos = ts.find('/', ap_pos);
+  }
 
-    unsigned short* flags;
-    int al;
-    if (ap_pos != std::string::npos && ap_pos != ts.size()) {
-      std::string ap(ts.substr(ap_pos + 1));
-      ts.resize(ap_pos);
-      if (!aliasf.empty()) {
-        int index = atoi(ap.c_str());
-        al = get_aliasf(index, &flags, dict);
-        if (!al) {
-          HUNSPELL_WARNING(stderr, "error: line %d: bad flag vector alias\n",
-                           dict->getlinenum());
-        }
+  unsigned short* flags;
+  int al;
+  if (ap_pos != std::string::npos && ap_pos != ts.size()) {
+    std::string ap(ts.substr(ap_pos + 1));
+    ts.resize(ap_pos);
+    if (!aliasf.empty()) {
+      int index = atoi(ap.c_str());
+      if (index > 0 && static_cast<size_t>(index) <= aliasflen.size()) {
+        flags = aliasf[index - 1];
+        al = aliasflen[index - 1];
       } else {
-        al = decode_flags(&flags, ap, dict, /* arena = */ true);
-        if (al == -1) {
-          HUNSPELL_WARNING(stderr, "Can't allocate memory.\n");
-          delete dict;
-          return 6;
-        }
-        std::sort(flags, flags + al);
+        HUNSPELL_WARNING(stderr, "error: line %d: bad flag vector alias\n",
+                         linenum);
+        flags = nullptr;
+        al = 0;
       }
     } else {
-      al = 0;
-      flags = nullptr;
+      al = decode_flags(&flags, ap, nullptr, &chunk.arena, linenum);
+      if (al == -1) {
+        HUNSPELL_WARNING(stderr, "Can't allocate memory.\n");
+        return 6;
+      }
+      std::sort(flags, flags + al);
     }
+  } else {
+    al = 0;
+    flags = nullptr;
+  }
 
-    int captype;
-    int wcl = get_clen_and_captype(ts, &captype, workbuf);
-    const std::string* dp_str = dp.empty() ? nullptr : &dp;
-    // add the word and its index plus its capitalized form optionally
-    // flags are arena-allocated, so own_aff must be false
-    bool own = false;
-    if (add_word(ts, wcl, flags, al, dp_str, false, captype, own) ||
-        add_hidden_capitalized_word(ts, wcl, flags, al, dp_str, captype)) {
-      delete dict;
-      return 5;
+  int captype;
+  int wcl = get_clen_and_captype(ts, &captype, workbuf);
+  const std::string* dp_str = dp.empty() ? nullptr : &dp;
+  // add the word and its index plus its capitalized form optionally
+  // flags are arena-allocated, so own_aff must be false
+  struct hentry* hp;
+  int bucket;
+  if (make_entry(ts, wcl, flags, al, dp_str, captype, false, chunk.arena, chunk.reptable, &hp, &bucket))
+    return 5;
+  chunk.entries.push_back({hp, bucket, false});
+  if (make_hidden_capitalized_entry(ts, wcl, flags, al, dp_str, captype, chunk.arena, chunk.reptable, &hp, &bucket))
+    return 5;
+  if (hp)
+    chunk.entries.push_back({hp, bucket, true});
+  return 0;
+}
+
+bool HashMgr::is_image(const char* path) {
+  std::ifstream in;
+  myopen(in, path, std::ios_base::in | std::ios_base::binary);
+  if (!in.is_open())
+    return false;
+  ImageHeader h;
+  if (!in.read(reinterpret_cast<char*>(&h), sizeof(h)))
+    return false;
+  in.seekg(0, std::ios_base::end);
+  return image_header_ok(h, static_cast<uint64_t>(in.tellg()));
+}
+
+bool HashMgr::save_image(const char* path) const {
+  std::string out(sizeof(ImageHeader), '\0');
+  auto align = [&out](size_t a) { out.resize((out.size() + a - 1) / a * a, '\0'); };
+  auto put = [&out](const void* p, size_t n) { out.append(static_cast<const char*>(p), n); };
+  auto put_u64 = [&put](uint64_t v) { put(&v, sizeof(v)); };
+  auto put_string = [&](const std::string& str) { put_u64(str.size()); put(str.data(), str.size()); };
+
+  ImageHeader h;
+  memset(&h, 0, sizeof(h));
+  memcpy(h.magic, IMAGE_MAGIC, sizeof(IMAGE_MAGIC));
+  h.version = IMAGE_VERSION;
+  h.endian = IMAGE_ENDIAN;
+  h.pointer_size = sizeof(void*);
+  h.hentry_size = sizeof(hentry);
+  h.flag_mode = flag_mode;
+  h.complexprefixes = complexprefixes;
+  h.utf8 = utf8;
+  h.langnum = langnum;
+  h.forbiddenword = forbiddenword;
+  h.table_size = tableptr.size();
+
+  h.strings_offset = out.size();
+  put_string(enc);
+  put_string(lang);
+  put_string(ignorechars);
+  put_u64(ignorechars_utf16.size());
+  put(ignorechars_utf16.data(), ignorechars_utf16.size() * sizeof(w_char));
+  put_u64(reptable.size());
+  for (const auto& rep : reptable) {
+    put_string(rep.pattern);
+    for (const auto& o : rep.outstrings)
+      put_string(o);
+  }
+
+  // flag vectors, once each: aliased ones are shared by many entries
+  std::unordered_map<const unsigned short*, uint64_t> flags_ref;
+  auto put_flags = [&](const unsigned short* flags, size_t len) -> uint64_t {
+    if (!flags)
+      return 0;
+    auto it = flags_ref.find(flags);
+    if (it != flags_ref.end())
+      return it->second;
+    align(alignof(unsigned short));
+    uint64_t ref = out.size() + 1;
+    put(flags, len * sizeof(unsigned short));
+    flags_ref.emplace(flags, ref);
+    return ref;
+  };
+
+  std::vector<const hentry*> entries;
+  for (auto bucket : tableptr) {
+    for (const hentry* hp = bucket; hp; hp = hp->next)
+      entries.push_back(hp); // homonyms are on the next chain, too
+  }
+  h.entry_count = entries.size();
+
+  std::vector<uint64_t> aliasf_refs;
+  for (size_t i = 0; i < aliasf.size(); ++i)
+    aliasf_refs.push_back(put_flags(aliasf[i], aliasflen[i]));
+  for (const hentry* hp : entries)
+    put_flags(hp->astr, hp->alen);
+
+  std::unordered_map<const char*, uint64_t> aliasm_index;
+  std::vector<uint64_t> aliasm_refs;
+  for (size_t i = 0; i < aliasm.size(); ++i) {
+    aliasm_index.emplace(aliasm[i], i + 1);
+    if (!aliasm[i]) {
+      aliasm_refs.push_back(0);
+      continue;
     }
+    aliasm_refs.push_back(out.size() + 1);
+    put(aliasm[i], strlen(aliasm[i]) + 1);
   }
 
-  int ret(0);
+  align(alignof(uint64_t));
+  h.aliasf_offset = out.size();
+  h.aliasf_count = aliasf.size();
+  for (size_t i = 0; i < aliasf.size(); ++i) {
+    put_u64(aliasf_refs[i]);
+    put_u64(aliasflen[i]);
+  }
+  h.aliasm_offset = out.size();
+  h.aliasm_count = aliasm.size();
+  for (uint64_t ref : aliasm_refs)
+    put_u64(ref);
+
+  // records are placed first so the buckets and next pointers can refer to them
+  h.buckets_offset = out.size();
+  size_t pos = h.buckets_offset + tableptr.size() * sizeof(uint64_t);
+  pos = (pos + alignof(hentry) - 1) & ~(alignof(hentry) - 1);
+  h.entries_offset = pos;
+  std::unordered_map<const hentry*, uint64_t> entry_ref;
+  entry_ref.reserve(entries.size());
+  for (const hentry* hp : entries) {
+    entry_ref.emplace(hp, pos + 1);
+    pos += hentry_record_size(hp);
+  }
+  h.entries_end = pos;
+  auto ref_of = [&entry_ref](const hentry* hp) -> uint64_t { return hp ? entry_ref.at(hp) : 0; };
+
+  for (auto bucket : tableptr)
+    put_u64(ref_of(bucket));
+  align(alignof(hentry));
+
+  for (const hentry* hp : entries) {
+    size_t off = out.size();
+    size_t size = hentry_record_size(hp);
+    out.resize(off + size, '\0');
+    memcpy(&out[off], hp, hentry_alloc_size(hp));
+    hentry* rec = reinterpret_cast<hentry*>(&out[off]);
+    rec->astr = ref_to_pointer<unsigned short>(hp->astr ? flags_ref.at(hp->astr) : 0);
+    rec->next = ref_to_pointer<hentry>(ref_of(hp->next));
+    rec->next_homonym = ref_to_pointer<hentry>(ref_of(hp->next_homonym));
+    rec->var &= ~H_OPT_OWNFLAGS;
+    if ((hp->var & H_OPT) && (hp->var & H_OPT_ALIASM)) {
+      auto it = aliasm_index.find(get_stored_pointer(HENTRY_WORD(hp) + hp->blen + 1));
+      store_pointer(HENTRY_WORD(rec) + rec->blen + 1,
+                    ref_to_pointer<char>(it != aliasm_index.end() ? it->second : 0));
+    }
+  }
 
-  // reject ludicrous tablesizes
-  if (tablesize > 8192 + nExtra && tablesize > nLineCount * 10 + nExtra) {
-    HUNSPELL_WARNING(stderr, ".dic initial approximate word count line value of %d is too large for %d lines\n", tablesize, nLineCount);
-    ret = 3;
+  h.total_size = out.size();
+  memcpy(&out[0], &h, sizeof(h));
+
+  std::ofstream file(path, std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+  if (!file.is_open())
+    return false;
+  file.write(out.data(), out.size());
+  return static_cast<bool>(file.flush());
+}
+
+// load an image written by save_image: one read, then the stored offsets
+// become pointers in place; no parsing, flag decoding, sorting or hashing
+int HashMgr::load_image(const char* path) {
+  std::ifstream in;
+  myopen(in, path, std::ios_base::in | std::ios_base::binary);
+  if (!in.is_open())
+    return 1;
+  in.seekg(0, std::ios_base::end);
+  const uint64_t size = static_cast<uint64_t>(in.tellg());
+  in.seekg(0, std::ios_base::beg);
+  if (size < sizeof(ImageHeader))
+    return 2;
+  auto chunk = std::make_unique<uint8_t[]>(size);
+  if (!in.read(reinterpret_cast<char*>(chunk.get()), size))
+    return 2;
+
+  uint8_t* base = chunk.get();
+  ImageHeader h;
+  memcpy(&h, base, sizeof(h));
+  if (!image_header_ok(h, size))
+    return 2;
+
+  // a stored reference is only turned into a pointer when what is read
+  // through it lies inside the file
+  bool ok = true;
+  auto pointer = [&](uint64_t ref, uint64_t bytes) -> uint8_t* {
+    if (!ref)
+      return nullptr;
+    if (ref > size || bytes > size - (ref - 1)) {
+      ok = false;
+      return nullptr;
+    }
+    return base + ref - 1;
+  };
+  auto flags_pointer = [&](uint64_t ref, uint64_t len) -> unsigned short* {
+    if (ref && (ref - 1) % alignof(unsigned short) != 0) {
+      ok = false;
+      return nullptr;
+    }
+    return reinterpret_cast<unsigned short*>(pointer(ref, len * sizeof(unsigned short)));
+  };
+  auto string_pointer = [&](uint64_t ref) -> char* {
+    uint8_t* p = pointer(ref, 1);
+    if (p && !memchr(p, '\0', size - (ref - 1))) {
+      ok = false;
+      return nullptr;
+    }
+    return reinterpret_cast<char*>(p);
+  };
+  uint64_t rpos = h.strings_offset;
+  auto get_u64 = [&]() -> uint64_t {
+    uint64_t v = 0;
+    if (rpos > size || size - rpos < sizeof(v)) {
+      ok = false;
+      return 0;
+    }
+    memcpy(&v, base + rpos, sizeof(v));
+    rpos += sizeof(v);
+    return v;
+  };
+  auto get_bytes = [&](void* dest, uint64_t n) {
+    if (n == 0)
+      return;
+    if (rpos > size || n > size - rpos) {
+      ok = false;
+      return;
+    }
+    memcpy(dest, base + rpos, n);
+    rpos += n;
+  };
+  auto get_string = [&](std::string& str) {
+    uint64_t n = get_u64();
+    if (!ok || n > size - rpos) {
+      ok = false;
+      return;
+    }
+    str.assign(reinterpret_cast<const char*>(base + rpos), n);
+    rpos += n;
+  };
+
+  flag_mode = static_cast<flag>(h.flag_mode);
+  complexprefixes = h.complexprefixes;
+  utf8 = h.utf8;
+  langnum = h.langnum;
+  forbiddenword = static_cast<unsigned short>(h.forbiddenword);
+
+  get_string(enc);
+  get_string(lang);
+  get_string(ignorechars);
+  uint64_t n = get_u64();
+  if (ok && n <= (size - rpos) / sizeof(w_char)) {
+    ignorechars_utf16.resize(n);
+    get_bytes(ignorechars_utf16.data(), n * sizeof(w_char));
+  }
+  n = get_u64();
+  if (ok && n <= (size - rpos) / sizeof(uint64_t)) {
+    reptable.resize(n);
+    for (auto& rep : reptable) {
+      get_string(rep.pattern);
+      for (auto& o : rep.outstrings)
+        get_string(o);
+    }
   }
+  if (!ok)
+    return 2;
+  if (!utf8 && !enc.empty())
+    csconv = get_current_cs(enc);
+
+  rpos = h.aliasf_offset;
+  for (uint64_t i = 0; i < h.aliasf_count && ok; ++i) {
+    uint64_t ref = get_u64();
+    auto len = static_cast<unsigned short>(get_u64());
+    aliasf.push_back(flags_pointer(ref, len));
+    aliasflen.push_back(len);
+  }
+  rpos = h.aliasm_offset;
+  for (uint64_t i = 0; i < h.aliasm_count && ok; ++i)
+    aliasm.push_back(string_pointer(get_u64()));
+
+  // every record has to fit before entries_end; where they start is what
+  // the bucket and chain references are checked against
+  const uint64_t entries_size = h.entries_end - h.entries_offset;
+  std::vector<bool> record_start((entries_size + alignof(hentry) - 1) / alignof(hentry), false);
+  uint64_t count = 0;
+  for (uint64_t off = h.entries_offset; ok && off < h.entries_end; ++count) {
+    size_t record = image_record_size(reinterpret_cast<hentry*>(base + off), h.entries_end - off);
+    if (!record || count == h.entry_count) {
+      ok = false;
+      break;
+    }
+    record_start[(off - h.entries_offset) / alignof(hentry)] = true;
+    off += record;
+  }
+  // save_image writes each chain in order, so a chain reference that does not
+  // lead to a later record can only come from a corrupt file (and could loop);
+  // a record is on one chain only, or free_table would release it twice
+  std::vector<bool> linked(record_start.size(), false);
+  auto entry_pointer = [&](uint64_t ref, uint64_t after, bool chain) -> hentry* {
+    if (!ref)
+      return nullptr;
+    uint64_t off = ref - 1 - h.entries_offset;
+    if (ref - 1 < after || off >= entries_size || off % alignof(hentry) != 0 ||
+        !record_start[off / alignof(hentry)] || (chain && linked[off / alignof(hentry)])) {
+      ok = false;
+      return nullptr;
+    }
+    if (chain)
+      linked[off / alignof(hentry)] = true;
+    return reinterpret_cast<hentry*>(base + ref - 1);
+  };
 
-  delete dict;
-  return ret;
+  for (uint64_t off = h.entries_offset; ok && off < h.entries_end;) {
+    auto hp = reinterpret_cast<hentry*>(base + off);
+    const uint64_t next_off = off + image_record_size(hp, h.entries_end - off);
+    if (hp->alen < 0) {
+      ok = false;
+      break;
+    }
+    hp->astr = flags_pointer(reinterpret_cast<uintptr_t>(hp->astr), hp->alen);
+    hp->next = entry_pointer(reinterpret_cast<uintptr_t>(hp->next), next_off, true);
+    hp->next_homonym = entry_pointer(reinterpret_cast<uintptr_t>(hp->next_homonym), next_off, false);
+    hp->var &= ~H_OPT_OWNFLAGS; // the flags are in the chunk, never freed on their own
+    if ((hp->var & H_OPT) && (hp->var & H_OPT_ALIASM)) {
+      uint64_t index = reinterpret_cast<uintptr_t>(get_stored_pointer(HENTRY_WORD(hp) + hp->blen + 1));
+      store_pointer(HENTRY_WORD(hp) + hp->blen + 1,
+                    index > 0 && index <= aliasm.size() ? aliasm[index - 1] : nullptr);
+    }
+    off = next_off;
+  }
+
+  rpos = h.buckets_offset;
+  tableptr.assign(h.table_size, nullptr);
+  for (auto& bucket : tableptr) {
+    bucket = entry_pointer(get_u64(), h.entries_offset, true);
+    if (!ok)
+      break;
+  }
+
+  if (!ok || count != h.entry_count) {
+    // nothing points into the chunk once these are dropped
+    tableptr.clear();
+    aliasf.clear();
+    aliasflen.clear();
+    aliasm.clear();
+    return 2;
+  }
+
+  // the whole file is one arena chunk: every entry, flag vector and alias is
+  // released through arena_free like their load_tables counterparts
+  arena.chunks.push_back(std::move(chunk));
+  arena.current_chunk_size = size;
+  arena.current_chunk_offset = size;
+  arena.outstanding_allocations += h.entry_count + h.aliasf_count + h.aliasm_count;
+
+  // chains in order, so the index keeps the first entry of each word
+  index_reserve(h.entry_count);
+  for (auto dp : tableptr) {
+    for (; dp; dp = dp->next)
+      index_insert(dp);
+  }
+  return 0;
 }
 
 // the hash function is a simple load and rotate
@@ -772,14 +1447,18 @@ int HashMgr::hash(const char* word, size_t len) const {
 }
 
 int HashMgr::decode_flags(unsigned short** result, const std::string& flags, FileMgr* af) const {
-  return decode_flags(result, flags, af, /* arena = */ false);
+  return decode_flags(result, flags, af, nullptr);
 }
 
-int HashMgr::decode_flags(unsigned short** result, const std::string& flags, FileMgr* af, bool use_arena) const {
+int HashMgr::decode_flags(unsigned short** result, const std::string& flags, FileMgr* af, Arena* flag_arena, int linenum) const {
+  // bad flags are reported with the line of af, or linenum when there is no FileMgr (0: not reported)
+  const bool report = af != nullptr || linenum > 0;
+  if (af)
+    linenum = af->getlinenum();
   auto alloc = [&](int n) -> unsigned short* {
-    return use_arena ? (unsigned short*)this->arena_alloc(n * sizeof(unsigned short),
-                                                          alignof(unsigned short))
-                     : new unsigned short[n];
+    return flag_arena ? (unsigned short*)flag_arena->alloc(n * sizeof(unsigned short),
+                                                           alignof(unsigned short))
+                      : new unsigned short[n];
   };
   int len;
   if (flags.empty()) {
@@ -789,9 +1468,9 @@ int HashMgr::decode_flags(unsigned short** result, const std::string& flags, Fil
   switch (flag_mode) {
     case FLAG_LONG: {  // two-character flags (1x2yZz -> 1x 2y Zz)
       len = flags.size();
-      if ((len & 1) == 1 && af != nullptr)
+      if ((len & 1) == 1 && report)
         HUNSPELL_WARNING(stderr, "error: line %d: bad flagvector\n",
-                         af->getlinenum());
+                         linenum);
       len >>= 1;
       *result = alloc(len);
       for (int i = 0; i < len; i++) {
@@ -811,31 +1490,31 @@ int HashMgr::decode_flags(unsigned short** result, const std::string& flags, Fil
       for (size_t p = 0; p < flags.size(); ++p) {
         if (flags[p] == ',') {
           int i = atoi(src);
-          if ((i > std::numeric_limits<unsigned short>::max() || i < 0) && af != nullptr) {
+          if ((i > std::numeric_limits<unsigned short>::max() || i < 0) && report) {
             HUNSPELL_WARNING(
                 stderr, "error: line %d: flag id %d is out of range\n",
-                af->getlinenum(), i);
+                linenum, i);
              i = 0;
           }
           *dest = (unsigned short)i;
-          if (*dest == 0 && af != nullptr)
+          if (*dest == 0 && report)
             HUNSPELL_WARNING(stderr, "error: line %d: 0 is wrong flag id\n",
-                             af->getlinenum());
+                             linenum);
           src = flags.c_str() + p + 1;
           dest++;
         }
       }
       int i = atoi(src);
-      if ((i > std::numeric_limits<unsigned short>::max() || i < 0) && af) {
+      if ((i > std::numeric_limits<unsigned short>::max() || i < 0) && report) {
         HUNSPELL_WARNING(stderr,
                          "error: line %d: flag id %d is out of range\n",
-                         af->getlinenum(), i);
+                         linenum, i);
         i = 0;
       }
       *dest = (unsigned short)i;
-      if (*dest == 0 && af)
+      if (*dest == 0 && report)
         HUNSPELL_WARNING(stderr, "error: line %d: 0 is wrong flag id\n",
-                         af->getlinenum());
+                         linenum);
       break;
     }
     case FLAG_UNI: {  // UTF-8 characters
@@ -1191,7 +1870,7 @@ bool HashMgr::parse_aliasf(const std::string& line, FileMgr* af) {
           case 1: {
             std::string piece(start_piece, iter);
             aliaslen =
-                (unsigned short)decode_flags(&alias, piece, af, /* arena = */ true);
+                (unsigned short)decode_flags(&alias, piece, af, &arena);
             std::sort(alias, alias + aliaslen);
             break;
           }
@@ -1437,7 +2116,7 @@ const std::vector<replentry>& HashMgr::get_reptable() const {
   return reptable;
 }
 
-void* HashMgr::arena_alloc(size_t num_bytes, size_t alignment) const {
+void* HashMgr::Arena::alloc(size_t num_bytes, size_t alignment) {
   // Fixed-size 64KB chunks: small enough to avoid significant waste on small
   // dictionaries, large enough to amortize per-chunk malloc overhead on large
   // ones. make_unique throws std::bad_alloc on OOM.
@@ -1449,7 +2128,7 @@ void* HashMgr::arena_alloc(size_t num_bytes, size_t alignment) const {
   // Pad the offset up to the requested alignment before placing this allocation.
   // make_unique returns memory aligned for any scalar, so chunk-start is fine.
   size_t aligned_offset = (current_chunk_offset + alignment - 1) & ~(alignment - 1);
-  if (arena.empty() || current_chunk_size - aligned_offset < num_bytes) {
+  if (chunks.empty() || current_chunk_size - aligned_offset < num_bytes) {
     // Round the new chunk's size up to a multiple of MAX_ALIGNMENT so that an
     // oversized num_bytes (>= MIN_CHUNK_SIZE) cannot leave a non-aligned
     // current_chunk_size that would later cause aligned_offset to overshoot.
@@ -1457,25 +2136,43 @@ void* HashMgr::arena_alloc(size_t num_bytes, size_t alignment) const {
     // leaves the HashMgr in a consistent state.
     size_t new_size = std::max(MIN_CHUNK_SIZE, num_bytes);
     new_size = (new_size + MAX_ALIGNMENT - 1) & ~(MAX_ALIGNMENT - 1);
-    arena.push_back(std::make_unique<uint8_t[]>(new_size));
+    chunks.push_back(std::make_unique<uint8_t[]>(new_size));
     current_chunk_size = new_size;
     aligned_offset = 0;
   }
 
-  uint8_t* ptr = &arena.back()[aligned_offset];
+  uint8_t* ptr = &chunks.back()[aligned_offset];
   current_chunk_offset = aligned_offset + num_bytes;
-  ++outstanding_arena_allocations;
+  ++outstanding_allocations;
   return ptr;
 }
 
+// take over the chunks of an arena filled on another thread; allocation
+// goes on in its last chunk, the tail of our current one is left unused
+void HashMgr::Arena::adopt(Arena& other) {
+  if (other.chunks.empty())
+    return;
+  for (auto& chunk : other.chunks)
+    chunks.push_back(std::move(chunk));
+  other.chunks.clear();
+  current_chunk_size = other.current_chunk_size;
+  current_chunk_offset = other.current_chunk_offset;
+  outstanding_allocations += other.outstanding_allocations;
+  other.outstanding_allocations = 0;
+}
+
+void* HashMgr::arena_alloc(size_t num_bytes, size_t alignment) const {
+  return arena.alloc(num_bytes, alignment);
+}
+
 void HashMgr::arena_free(void*) const {
   // The arena vector owns all allocations and frees them in bulk at HashMgr
   // destruction, so this is a no-op for the memory itself. The counter is a
   // memory-safety check: more arena_free calls than arena_alloc calls would
   // indicate a double-free or use-after-free in Hunspell. Abort hard rather
   // than silently desynchronize tracking, even in release builds.
-  if (outstanding_arena_allocations == 0) {
+  if (arena.outstanding_allocations == 0) {
     std::abort();
   }
-  --outstanding_arena_allocations;
+  --arena.outstanding_allocations;
 }
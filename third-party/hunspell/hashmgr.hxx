@@ -89,8 +89,26 @@ enum flag { FLAG_CHAR, FLAG_LONG, FLAG_NUM, FLAG_UNI };
 // ratio of lines/lines with "ph:" in the dic file: 1/MORPH_PHON_RATIO
 #define MORPH_PHON_RATIO 500
 
+// upper limit of the threads building the hash entries of a .dic file
+#ifndef HUNSPELL_LOAD_THREADS
+#define HUNSPELL_LOAD_THREADS 8
+#endif
+
 class HashMgr {
   std::vector<struct hentry*> tableptr;
+  // open addressing index for lookup, next to the chains (which keep the
+  // word order walk_hashtable and the homonym lists rely on): the first entry
+  // of every distinct word, found by probing the dense key array linearly
+  std::vector<uint32_t> index_keys;  // 0 for a free slot, see index_key
+  std::vector<struct hentry*> index_entries;
+  size_t index_count = 0;
+  // blocked Bloom filter over the indexed words, sized and rebuilt with the
+  // index (one byte per slot): an absent word is mostly turned away after
+  // reading one 512-bit block, before the key array is touched
+  std::vector<uint64_t> bloom;
+  mutable size_t lookup_count = 0;
+  mutable size_t lookup_misses = 0;
+  mutable size_t bloom_rejects = 0;
   flag flag_mode;
   int complexprefixes;
   int utf8;
@@ -108,14 +126,23 @@ class HashMgr {
   // of the dic file. It contains phonetic and other common misspellings
   // (letters, letter groups and words) for better suggestions
   std::vector<replentry> reptable;
+  // entries of the words added after loading (add, add_with_flags,
+  // add_with_affix), in the order they went in
+  std::vector<struct hentry*> added;
 
  public:
   HashMgr(const char* tpath, const char* apath, const char* key = nullptr);
   ~HashMgr();
 
   struct hentry* lookup(const char* word, size_t len) const;
+  // lookups so far, the words among them not in the table, and the part of
+  // those the Bloom filter answered on its own
+  void lookup_stats(size_t* lookups, size_t* misses, size_t* rejected) const;
+  // bytes of the lookup index and its Bloom filter, on top of the chains
+  size_t get_index_memory() const;
   int hash(const char* word, size_t len) const;
   struct hentry* walk_hashtable(int& col, struct hentry* hp) const;
+  const std::vector<struct hentry*>& get_added() const;
 
   int add(const std::string& word);
   int add_with_flags(const std::string& word, const std::string& flags, const std::string& desc = "");
@@ -131,10 +158,17 @@ class HashMgr {
   char* get_aliasm(int index) const;
   const std::vector<replentry>& get_reptable() const;
 
+  // precompiled image of the built table and the .aff settings it depends on,
+  // loaded instead of the .dic (see load_image); specific to the platform and
+  // to this build, so meant as a local cache next to the real dictionary
+  bool save_image(const char* path) const;
+  static bool is_image(const char* path); // an image this build can load
+
  private:
-  int get_clen_and_captype(const std::string& word, int* captype);
-  int get_clen_and_captype(const std::string& word, int* captype, std::vector<w_char> &workbuf);
+  int get_clen_and_captype(const std::string& word, int* captype) const;
+  int get_clen_and_captype(const std::string& word, int* captype, std::vector<w_char> &workbuf) const;
   int load_tables(const char* tpath, const char* key);
+  int load_image(const char* path);
   int add_word(const std::string& word,
                int wcl,
                unsigned short* ap,
@@ -155,21 +189,72 @@ class HashMgr {
   bool parse_reptable(const std::string& line, FileMgr* af);
   void remove_forbidden_flag(const std::string& word);
   void free_table();
-  void release_flags(unsigned short* astr, bool owned);
-
-  // Only internal consumers are allowed to arena-allocate.
-  int decode_flags(unsigned short** result, const std::string& flags, FileMgr* af, bool use_arena) const;
+  void release_flags(unsigned short* astr, bool owned) const;
 
   // Bump-pointer arena for load-time hentry/flag/aliasm allocations. Freed in
   // bulk at destruction. arena_free is a no-op that tracks outstanding allocs
   // and aborts on underflow. Mutable so const decode_flags can arena-allocate.
+  // Each load_tables thread fills an Arena of its own; its chunks are handed
+  // over to the HashMgr one with adopt once parsing is done.
+  struct Arena {
+    std::vector<std::unique_ptr<uint8_t[]>> chunks;
+    size_t current_chunk_size = 0;
+    size_t current_chunk_offset = 0;
+    size_t outstanding_allocations = 0;
+
+    void* alloc(size_t num_bytes, size_t alignment);
+    void adopt(Arena& other);
+  };
+
+  // entries of a range of .dic lines, built off the table by one thread
+  struct DicChunk {
+    struct Entry {
+      struct hentry* hp;
+      int bucket;
+      bool onlyupcase;
+    };
+    std::vector<Entry> entries; // in line order
+    std::vector<replentry> reptable; // from ph: fields, in line order
+    Arena arena;
+    int error = 0; // load_tables error code of the first failing line
+  };
+
+  int parse_dic_line(std::string& ts, int linenum, DicChunk& chunk, std::vector<w_char>& workbuf) const;
+  // build the record of add_word without touching the table; 0 or 1 on error
+  int make_entry(const std::string& word,
+                 int wcl,
+                 unsigned short* aff,
+                 int al,
+                 const std::string* desc,
+                 int captype,
+                 bool own_aff,
+                 Arena& entry_arena,
+                 std::vector<replentry>& reps,
+                 struct hentry** hp,
+                 int* bucket) const;
+  // *hp is null when the word needs no hidden capitalized form
+  int make_hidden_capitalized_entry(const std::string& word,
+                                    int wcl,
+                                    unsigned short* flags,
+                                    int flagslen,
+                                    const std::string* dp,
+                                    int captype,
+                                    Arena& entry_arena,
+                                    std::vector<replentry>& reps,
+                                    struct hentry** hp,
+                                    int* bucket) const;
+  bool link_entry(struct hentry* hp, int bucket, bool onlyupcase);
+  void index_reserve(size_t words);
+  void index_insert(struct hentry* hp);
+
+  // Only internal consumers are allowed to arena-allocate; flags come from
+  // flag_arena, or from new[] without one.
+  int decode_flags(unsigned short** result, const std::string& flags, FileMgr* af, Arena* flag_arena, int linenum = 0) const;
+
   void* arena_alloc(size_t num_bytes, size_t alignment) const;
   void arena_free(void* ptr) const;
 
-  mutable std::vector<std::unique_ptr<uint8_t[]>> arena;
-  mutable size_t current_chunk_size = 0;
-  mutable size_t current_chunk_offset = 0;
-  mutable size_t outstanding_arena_allocations = 0;
+  mutable Arena arena;
 };
 
 #endif
@@ -79,6 +79,7 @@
 #include "hunspell.h"
 #include "csutil.hxx"
 
+#include <algorithm>
 #include <limits>
 #include <memory>
 #include <string>
@@ -86,6 +87,12 @@
 #define MAXWORDUTF8LEN (MAXWORDLEN * 3)
 #define MAXSPELLMLLEN 8192
 
+// buffers spell_internal works in, kept by spell_batch across words
+struct SpellScratch {
+  std::string scw;
+  std::vector<w_char> sunicw;
+};
+
 class HunspellImpl
 {
 public:
@@ -94,6 +101,10 @@ public:
  HunspellImpl& operator=(const HunspellImpl&) = delete;
  ~HunspellImpl();
  int add_dic(const char* dpath, const char* key = nullptr);
+ bool save_dic_image(const char* path) const;
+ void lookup_stats(size_t* lookups, size_t* misses, size_t* rejected) const;
+ SuggestIndex* create_suggest_index() const;
+ void set_suggest_index(SuggestIndex* index);
  std::vector<std::string> suffix_suggest(const std::string& root_word);
  std::vector<std::string> generate(const std::string& word, const std::vector<std::string>& pl);
  std::vector<std::string> generate(const std::string& word, const std::string& pattern);
@@ -107,6 +118,7 @@ public:
             int* info = nullptr,
             std::string* root = nullptr,
             std::chrono::steady_clock::time_point suggest_start = std::chrono::steady_clock::time_point::max());
+ size_t spell_batch(const char* words, size_t count, uint64_t* verdicts);
  std::vector<std::string> suggest(const std::string& word);
  std::vector<std::string> suggest(const std::string& word,
                                   std::vector<std::string>& suggest_candidate_stack,
@@ -153,7 +165,8 @@ private:
                       std::vector<std::string>& candidate_stack,
                       int* info = nullptr,
                       std::string* root = nullptr,
-                      std::chrono::steady_clock::time_point suggest_start = std::chrono::steady_clock::time_point::max());
+                      std::chrono::steady_clock::time_point suggest_start = std::chrono::steady_clock::time_point::max(),
+                      SpellScratch* scratch = nullptr);
   std::vector<std::string> suggest_internal(const std::string& word,
                                             std::vector<std::string>& spell_candidate_stack,
                                             std::vector<std::string>& suggest_candidate_stack,
@@ -228,6 +241,29 @@ int HunspellImpl::add_dic(const char* dpath, const char* key) {
   return 0;
 }
 
+bool HunspellImpl::save_dic_image(const char* path) const {
+  return !m_HMgrs.empty() && m_HMgrs[0]->save_image(path);
+}
+
+void HunspellImpl::lookup_stats(size_t* lookups, size_t* misses, size_t* rejected) const {
+  *lookups = *misses = *rejected = 0;
+  for (const auto& hmgr : m_HMgrs) {
+    size_t l, m, r;
+    hmgr->lookup_stats(&l, &m, &r);
+    *lookups += l;
+    *misses += m;
+    *rejected += r;
+  }
+}
+
+SuggestIndex* HunspellImpl::create_suggest_index() const {
+  return new SuggestIndex(m_HMgrs, utf8, csconv, langnum);
+}
+
+void HunspellImpl::set_suggest_index(SuggestIndex* index) {
+  pSMgr->set_index(index);
+}
+
 
 // make a copy of src at dest while removing all characters
 // specified in IGNORE rule
@@ -475,9 +511,39 @@ bool HunspellImpl::spell(const std::string& word, std::vector<std::string>& cand
   return r;
 }
 
+size_t HunspellImpl::spell_batch(const char* words, size_t count, uint64_t* verdicts) {
+  std::fill(verdicts, verdicts + (count + 63) / 64, uint64_t(0));
+
+  // set up once: spell() builds these for every word
+  std::vector<std::string> candidate_stack;
+  candidate_stack.reserve(MAXBREAKDEPTH + 1);
+  candidate_stack.emplace_back();
+  std::string word;
+  SpellScratch scratch;
+
+  size_t good = 0;
+  const char* p = words;
+  for (size_t i = 0; i < count; ++i) {
+    const size_t len = strlen(p);
+    word.assign(p, len);
+    p += len + 1;
+
+    // the bottom of the recursion guard is this word, wordbreak recursion pushes and pops above it
+    candidate_stack.resize(1);
+    candidate_stack[0].assign(word);
+
+    if (spell_internal(word, candidate_stack, nullptr, nullptr, std::chrono::steady_clock::now(), &scratch)) {
+      verdicts[i / 64] |= uint64_t(1) << (i % 64);
+      ++good;
+    }
+  }
+  return good;
+}
+
 bool HunspellImpl::spell_internal(const std::string& word, std::vector<std::string>& candidate_stack,
                                   int* info, std::string* root,
-                                  std::chrono::steady_clock::time_point suggest_start) {
+                                  std::chrono::steady_clock::time_point suggest_start,
+                                  SpellScratch* scratch) {
   struct hentry* rv = nullptr;
 
   int info2 = 0;
@@ -500,8 +566,11 @@ bool HunspellImpl::spell_internal(const std::string& word, std::vector<std::stri
   size_t abbv = 0;
   size_t wl = 0;
 
-  std::string scw;
-  std::vector<w_char> sunicw;
+  // the caller's buffers when batching (cleanword2 clears them), else fresh ones
+  std::string local_scw;
+  std::vector<w_char> local_sunicw;
+  std::string& scw = scratch ? scratch->scw : local_scw;
+  std::vector<w_char>& sunicw = scratch ? scratch->sunicw : local_sunicw;
 
   // input conversion
   RepList* rl = pAMgr ? pAMgr->get_iconvtable() : nullptr;
@@ -2179,12 +2248,36 @@ int Hunspell::add_dic(const char* dpath, const char* key) {
   return m_Impl->add_dic(dpath, key);
 }
 
+bool Hunspell::save_dic_image(const char* path) const {
+  return m_Impl->save_dic_image(path);
+}
+
+bool Hunspell::is_dic_image(const char* path) {
+  return HashMgr::is_image(path);
+}
+
+void Hunspell::lookup_stats(size_t* lookups, size_t* misses, size_t* rejected) const {
+  m_Impl->lookup_stats(lookups, misses, rejected);
+}
+
+SuggestIndex* Hunspell::create_suggest_index() const {
+  return m_Impl->create_suggest_index();
+}
+
+void Hunspell::set_suggest_index(SuggestIndex* index) {
+  m_Impl->set_suggest_index(index);
+}
+
 bool Hunspell::spell(const std::string& word, int* info, std::string* root) {
   std::vector<std::string> candidate_stack;
   return m_Impl->spell(word, candidate_stack, info, root,
                        std::chrono::steady_clock::now());
 }
 
+size_t Hunspell::spell_batch(const char* words, size_t count, uint64_t* verdicts) {
+  return m_Impl->spell_batch(words, count, verdicts);
+}
+
 std::vector<std::string> Hunspell::suggest(const std::string& word) {
   return m_Impl->suggest(word);
 }
@@ -74,6 +74,7 @@
 #include "hunversion.h"
 #include "w_char.hxx"
 #include "atypes.hxx"
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -99,6 +100,7 @@
 #endif
 
 class HunspellImpl;
+class SuggestIndex;
 
 class LIBHUNSPELL_DLL_EXPORTED Hunspell {
  private:
@@ -121,6 +123,37 @@ class LIBHUNSPELL_DLL_EXPORTED Hunspell {
   /* load extra dictionaries (only dic files) */
   int add_dic(const char* dpath, const char* key = nullptr);
 
+  /* save_dic_image(path) - write the loaded main dictionary as a binary image
+   * Passing the image instead of the .dic file to the constructor (with the
+   * same .aff file) loads the same table without parsing it. Images depend
+   * on the platform and the library build, check them with is_dic_image.
+   * output: false if the file couldn't be written
+   */
+  bool save_dic_image(const char* path) const;
+  static bool is_dic_image(const char* path);
+
+  /* lookup_stats() - dictionary lookups since loading, over all dictionaries
+   * output: lookups, the absent words among them and how many of those the
+   * Bloom filter turned away without probing the table
+   */
+  void lookup_stats(size_t* lookups, size_t* misses, size_t* rejected) const;
+
+  /* create_suggest_index() - deletion index of the dictionary roots for the
+   * ngram suggestions (see suggestindex.hxx), empty until built or loaded
+   * It lists the roots of the dictionaries loaded so far; its build, load
+   * and save may then run on another thread while this object is in use,
+   * as long as this object outlives them.
+   */
+  SuggestIndex* create_suggest_index() const;
+
+  /* set_suggest_index(index) - the ngram suggestions take the roots near
+   * a misspelling from the index instead of scoring every root of the
+   * dictionaries; same ranking and merge with the other suggestions
+   * input: a built or loaded index of this object, owned from now on;
+   * nullptr (or an index that isn't ready) goes back to the scan
+   */
+  void set_suggest_index(SuggestIndex* index);
+
   /* spell(word) - spellcheck word
    * output: false = bad word, true = good word
    *
@@ -133,6 +166,17 @@ class LIBHUNSPELL_DLL_EXPORTED Hunspell {
   bool spell(const std::string& word, int* info = nullptr, std::string* root = nullptr);
   H_DEPRECATED int spell(const char* word, int* info = nullptr, char** root = nullptr);
 
+  /* spell_batch(words, count, verdicts) - spellcheck many words in one call
+   * input: count NUL-terminated words stored back to back in words
+   *   ("the\0and\0..."), in the dictionary encoding
+   * output: bit (i % 64) of verdicts[i / 64] is set when word i is good,
+   *   verdicts must hold (count + 63) / 64 entries; returns the number of
+   *   good words
+   * Same verdicts as spell(word) word by word, but the scratch buffers are
+   * set up once for the whole batch.
+   */
+  size_t spell_batch(const char* words, size_t count, uint64_t* verdicts);
+
   /* suggest(suggestions, word) - search suggestions
    * input: pointer to an array of strings pointer and the (bad) word
    *   array of strings pointer (here *slst) may not be initialized
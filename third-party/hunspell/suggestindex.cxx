@@ -0,0 +1,366 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1/GPL 2.0/LGPL 2.1
+ *
+ * Copyright (C) 2002-2022 Németh László
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * Hunspell is based on MySpell which is Copyright (C) 2002 Kevin Hendricks.
+ *
+ * Contributor(s): David Einstein, Davide Prina, Giuseppe Modugno,
+ * Gianluca Turconi, Simon Brouwer, Noll János, Bíró Árpád,
+ * Goldman Eleonóra, Sarlós Tamás, Bencsáth Boldizsár, Halácsy Péter,
+ * Dvornik László, Gefferth András, Nagy Viktor, Varga Dániel, Chris Halls,
+ * Rene Engelhard, Bram Moolenaar, Dafydd Jones, Harri Pitkänen
+ *
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <string>
+
+#include "suggestindex.hxx"
+#include "csutil.hxx"
+
+static_assert(SUGGESTINDEX_PREFIX <= 7, "deletion_hash packs at most 7 characters");
+
+namespace {
+
+// a posting, see SuggestIndex::postings
+const int ROOT_BITS = 24;
+const uint32_t ROOT_MASK = (1U << ROOT_BITS) - 1;
+
+inline uint32_t posting(uint32_t hash, uint32_t root) {
+  return (hash & ~ROOT_MASK) | root;
+}
+
+// Index cache, see SuggestIndex::save. After the header: the bucket starts,
+// the postings and the unindexed roots, each laid out as in memory.
+const char INDEX_MAGIC[8] = {'H', 'U', 'N', 'S', 'I', 'D', 'X', '\n'};
+const uint32_t INDEX_VERSION = 1;
+const uint32_t INDEX_ENDIAN = 0x01020304;
+
+struct IndexHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t endian;
+  uint32_t prefix;
+  int32_t utf8;
+  int32_t langnum;
+  uint32_t reserved;
+  uint64_t root_count;
+  uint64_t roots_digest;
+  uint64_t bucket_count;
+  uint64_t posting_count;
+  uint64_t unindexed_count;
+  uint64_t total_size;
+};
+
+// hash of key without the characters at skip1 and skip2 (-1 for none): the
+// rest is packed into two words, its length in the top bits, then mixed
+// (splitmix64 constants)
+inline uint32_t deletion_hash(const uint16_t* key, int len, int skip1, int skip2) {
+  uint64_t lo = 0, hi = 0;
+  int n = 0;
+  for (int i = 0; i < len; ++i) {
+    if (i == skip1 || i == skip2)
+      continue;
+    if (n < 4)
+      lo |= static_cast<uint64_t>(key[i]) << (16 * n);
+    else
+      hi |= static_cast<uint64_t>(key[i]) << (16 * (n - 4));
+    ++n;
+  }
+  hi |= static_cast<uint64_t>(n) << 48;
+  uint64_t h = (lo ^ 0x9E3779B97F4A7C15ULL) * 0xBF58476D1CE4E5B9ULL;
+  h ^= h >> 29;
+  h = (h ^ hi) * 0x94D049BB133111EBULL;
+  return static_cast<uint32_t>(h ^ (h >> 32));
+}
+
+// the key and what is left of it after deleting one or two characters,
+// hashed; a doubled letter gives the same deletion twice
+void add_deletions(const uint16_t* key, int len, std::vector<uint32_t>& out) {
+  out.push_back(deletion_hash(key, len, -1, -1));
+  for (int i = 0; i < len; ++i) {
+    out.push_back(deletion_hash(key, len, i, -1));
+    for (int j = i + 1; j < len; ++j)
+      out.push_back(deletion_hash(key, len, i, j));
+  }
+}
+
+void sort_unique(std::vector<uint32_t>& v) {
+  std::sort(v.begin(), v.end());
+  v.erase(std::unique(v.begin(), v.end()), v.end());
+}
+
+}
+
+SuggestIndex::SuggestIndex(const std::vector<std::unique_ptr<HashMgr>>& rHMgr,
+                           int utf8,
+                           const struct cs_info* csconv,
+                           int langnum)
+    : utf8(utf8), csconv(csconv), langnum(langnum), ready(false), cancelled(false) {
+  for (const auto& hmgr : rHMgr) {
+    int col = -1;
+    for (struct hentry* hp = hmgr->walk_hashtable(col, nullptr); hp; hp = hmgr->walk_hashtable(col, hp))
+      roots.push_back(hp);
+    added.push_back(hmgr->get_added().size());
+  }
+}
+
+// the first max characters of word, lower cased, as 16 bit units; -1 if the
+// word has characters outside the BMP
+int SuggestIndex::make_key(const char* word, size_t len, size_t max, std::vector<uint16_t>& key) const {
+  key.clear();
+  if (utf8) {
+    std::vector<w_char> w;
+    if (u8_u16(w, std::string(word, len)) == -1)
+      return -1;
+    if (w.size() > max)
+      w.resize(max);
+    mkallsmall_utf(w, langnum);
+    for (const w_char& c : w)
+      key.push_back(static_cast<uint16_t>((c.h << 8) | c.l));
+  } else {
+    std::string s(word, std::min(len, max));
+    if (csconv)
+      mkallsmall(s, csconv);
+    for (char c : s)
+      key.push_back(static_cast<unsigned char>(c));
+  }
+  return static_cast<int>(key.size());
+}
+
+bool SuggestIndex::build() {
+  ready = false;
+  starts.clear();
+  postings.clear();
+  unindexed.clear();
+
+  // keys of the roots, SUGGESTINDEX_PREFIX units apart; 0 long if unindexed
+  std::vector<uint16_t> keys(roots.size() * SUGGESTINDEX_PREFIX);
+  std::vector<unsigned char> lens(roots.size(), 0);
+  std::vector<uint16_t> key;
+  std::vector<uint32_t> dels;
+  size_t total = 0;
+  if (roots.size() > ROOT_MASK + 1)
+    return false;
+  for (size_t i = 0; i < roots.size(); ++i) {
+    if ((i & 4095) == 0 && cancelled.load(std::memory_order_relaxed))
+      return false;
+    int len = make_key(HENTRY_WORD(roots[i]), roots[i]->blen, SUGGESTINDEX_PREFIX, key);
+    if (len <= 0) {
+      unindexed.push_back(static_cast<uint32_t>(i));
+      continue;
+    }
+    std::copy(key.begin(), key.end(), keys.begin() + i * SUGGESTINDEX_PREFIX);
+    lens[i] = static_cast<unsigned char>(len);
+    dels.clear();
+    add_deletions(&keys[i * SUGGESTINDEX_PREFIX], len, dels);
+    sort_unique(dels);
+    total += dels.size();
+  }
+  if (total > std::numeric_limits<uint32_t>::max())
+    return false;
+
+  // the deletions are made again for counting and for placing, cheaper
+  // than keeping them all in between
+  auto for_each_posting = [&](auto&& f) {
+    for (size_t i = 0; i < roots.size(); ++i) {
+      if (!lens[i])
+        continue;
+      dels.clear();
+      add_deletions(&keys[i * SUGGESTINDEX_PREFIX], lens[i], dels);
+      sort_unique(dels);
+      for (uint32_t h : dels)
+        f(h, static_cast<uint32_t>(i));
+    }
+  };
+
+  // four to eight postings a bucket, read together in one line; the
+  // bucket bits stay clear of the ones kept in the postings
+  size_t buckets = 1;
+  while (buckets * 8 < total && buckets <= ROOT_MASK)
+    buckets <<= 1;
+  const uint32_t mask = static_cast<uint32_t>(buckets - 1);
+  starts.assign(buckets + 1, 0);
+  for_each_posting([&](uint32_t h, uint32_t) { ++starts[(h & mask) + 1]; });
+  for (size_t b = 0; b < buckets; ++b)
+    starts[b + 1] += starts[b];
+  if (cancelled.load(std::memory_order_relaxed))
+    return false;
+
+  postings.resize(total);
+  std::vector<uint32_t> fill(starts.begin(), starts.end() - 1);
+  for_each_posting([&](uint32_t h, uint32_t i) { postings[fill[h & mask]++] = posting(h, i); });
+  ready = true;
+  return true;
+}
+
+void SuggestIndex::cancel() {
+  cancelled.store(true, std::memory_order_relaxed);
+}
+
+bool SuggestIndex::is_ready() const {
+  return ready;
+}
+
+size_t SuggestIndex::get_root_count() const {
+  return roots.size();
+}
+
+size_t SuggestIndex::get_memory_size() const {
+  return roots.size() * sizeof(struct hentry*) + starts.size() * sizeof(uint32_t) +
+         postings.size() * sizeof(uint32_t) + unindexed.size() * sizeof(uint32_t);
+}
+
+size_t SuggestIndex::get_dic_count() const {
+  return added.size();
+}
+
+size_t SuggestIndex::get_added_count(size_t dic) const {
+  return added[dic];
+}
+
+bool SuggestIndex::candidates(const char* word, std::vector<struct hentry*>& out) const {
+  out.clear();
+  std::vector<uint16_t> w;
+  int n = ready ? make_key(word, strlen(word), std::string::npos, w) : -1;
+  if (n < 0)
+    return false;
+
+  // the word and its parts left after cutting up to SUGGESTINDEX_AFFIX
+  // characters from its ends, each cut to its key
+  std::vector<uint32_t> dels;
+  for (int head = 0; head <= SUGGESTINDEX_AFFIX && head < n; ++head) {
+    for (int tail = 0; head + tail <= SUGGESTINDEX_AFFIX && head + tail < n; ++tail) {
+      int len = n - head - tail;
+      // a part still longer than a key gives the key of the uncut one
+      if (tail > 0 && len >= SUGGESTINDEX_PREFIX)
+        continue;
+      add_deletions(&w[head], std::min(len, SUGGESTINDEX_PREFIX), dels);
+    }
+  }
+  sort_unique(dels);
+
+  const uint32_t mask = static_cast<uint32_t>(starts.size() - 2);
+  std::vector<uint32_t> ids(unindexed);
+  for (uint32_t h : dels) {
+    for (uint32_t p = starts[h & mask], end = starts[(h & mask) + 1]; p < end; ++p) {
+      if ((postings[p] & ~ROOT_MASK) == (h & ~ROOT_MASK))
+        ids.push_back(postings[p] & ROOT_MASK);
+    }
+  }
+  sort_unique(ids);
+  out.reserve(ids.size());
+  for (uint32_t id : ids)
+    out.push_back(roots[id]);
+  return true;
+}
+
+// FNV-1a over the root words in order, what a cached index is checked against
+uint64_t SuggestIndex::roots_digest() const {
+  uint64_t h = 0xCBF29CE484222325ULL;
+  for (const struct hentry* hp : roots) {
+    for (unsigned short i = 0; i <= hp->blen; ++i)  // with the terminating NUL
+      h = (h ^ static_cast<unsigned char>(hp->word[i])) * 0x100000001B3ULL;
+  }
+  return h;
+}
+
+bool SuggestIndex::save(const char* path) const {
+  if (!ready)
+    return false;
+  IndexHeader h;
+  memset(&h, 0, sizeof(h));
+  memcpy(h.magic, INDEX_MAGIC, sizeof(INDEX_MAGIC));
+  h.version = INDEX_VERSION;
+  h.endian = INDEX_ENDIAN;
+  h.prefix = SUGGESTINDEX_PREFIX;
+  h.utf8 = utf8;
+  h.langnum = langnum;
+  h.root_count = roots.size();
+  h.roots_digest = roots_digest();
+  h.bucket_count = starts.size() - 1;
+  h.posting_count = postings.size();
+  h.unindexed_count = unindexed.size();
+  h.total_size = sizeof(h) + starts.size() * sizeof(uint32_t) + postings.size() * sizeof(uint32_t) +
+                 unindexed.size() * sizeof(uint32_t);
+
+  std::ofstream file(path, std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+  if (!file.is_open())
+    return false;
+  file.write(reinterpret_cast<const char*>(&h), sizeof(h));
+  file.write(reinterpret_cast<const char*>(starts.data()), starts.size() * sizeof(uint32_t));
+  file.write(reinterpret_cast<const char*>(postings.data()), postings.size() * sizeof(uint32_t));
+  file.write(reinterpret_cast<const char*>(unindexed.data()), unindexed.size() * sizeof(uint32_t));
+  return static_cast<bool>(file.flush());
+}
+
+bool SuggestIndex::load(const char* path) {
+  std::ifstream in;
+  myopen(in, path, std::ios_base::in | std::ios_base::binary);
+  if (!in.is_open())
+    return false;
+  in.seekg(0, std::ios_base::end);
+  const uint64_t size = static_cast<uint64_t>(in.tellg());
+  in.seekg(0, std::ios_base::beg);
+  IndexHeader h;
+  if (size < sizeof(h) || !in.read(reinterpret_cast<char*>(&h), sizeof(h)))
+    return false;
+  // the counts are bounded by the file size before anything is allocated
+  if (memcmp(h.magic, INDEX_MAGIC, sizeof(INDEX_MAGIC)) != 0 || h.version != INDEX_VERSION ||
+      h.endian != INDEX_ENDIAN || h.prefix != SUGGESTINDEX_PREFIX || h.utf8 != utf8 ||
+      h.langnum != langnum || h.root_count != roots.size() || h.total_size != size ||
+      h.bucket_count == 0 || (h.bucket_count & (h.bucket_count - 1)) != 0 || h.bucket_count > ROOT_MASK + 1 ||
+      h.bucket_count > size || h.posting_count > size || h.unindexed_count > size ||
+      h.total_size != sizeof(h) + (h.bucket_count + 1) * sizeof(uint32_t) +
+                          h.posting_count * sizeof(uint32_t) + h.unindexed_count * sizeof(uint32_t) ||
+      h.roots_digest != roots_digest())
+    return false;
+
+  starts.resize(h.bucket_count + 1);
+  postings.resize(h.posting_count);
+  unindexed.resize(h.unindexed_count);
+  in.read(reinterpret_cast<char*>(starts.data()), starts.size() * sizeof(uint32_t));
+  in.read(reinterpret_cast<char*>(postings.data()), postings.size() * sizeof(uint32_t));
+  in.read(reinterpret_cast<char*>(unindexed.data()), unindexed.size() * sizeof(uint32_t));
+  bool ok = static_cast<bool>(in) && starts.front() == 0 && starts.back() == postings.size();
+  for (size_t b = 0; ok && b + 1 < starts.size(); ++b)
+    ok = starts[b] <= starts[b + 1];
+  for (size_t p = 0; ok && p < postings.size(); ++p)
+    ok = (postings[p] & ROOT_MASK) < roots.size();
+  for (size_t u = 0; ok && u < unindexed.size(); ++u)
+    ok = unindexed[u] < roots.size();
+  if (!ok) {
+    starts.clear();
+    postings.clear();
+    unindexed.clear();
+    return false;
+  }
+  ready = true;
+  return true;
+}
@@ -0,0 +1,120 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1/GPL 2.0/LGPL 2.1
+ *
+ * Copyright (C) 2002-2022 Németh László
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * Hunspell is based on MySpell which is Copyright (C) 2002 Kevin Hendricks.
+ *
+ * Contributor(s): David Einstein, Davide Prina, Giuseppe Modugno,
+ * Gianluca Turconi, Simon Brouwer, Noll János, Bíró Árpád,
+ * Goldman Eleonóra, Sarlós Tamás, Bencsáth Boldizsár, Halácsy Péter,
+ * Dvornik László, Gefferth András, Nagy Viktor, Varga Dániel, Chris Halls,
+ * Rene Engelhard, Bram Moolenaar, Dafydd Jones, Harri Pitkänen
+ *
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+#ifndef SUGGESTINDEX_HXX_
+#define SUGGESTINDEX_HXX_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "hashmgr.hxx"
+
+// characters of a root the deletions are taken from (the prefix length of
+// SymSpell): longer roots are filed under their beginning only
+#define SUGGESTINDEX_PREFIX 7
+// characters cut from the ends of a misspelling before its deletions are
+// looked up, the length difference ngsuggest allows between word and root:
+// the cut part stands for an affix the root is missing
+#define SUGGESTINDEX_AFFIX 4
+
+// Deletion neighbourhood index of the dictionary roots (symmetric delete):
+// every root is filed under the strings its first SUGGESTINDEX_PREFIX
+// characters, lower cased, leave after deleting up to two of them. Two
+// strings within edit distance 2 share such a deletion, so ngsuggest finds
+// the roots near a misspelling with a few hundred hash lookups instead of
+// scoring every root of the dictionary.
+//
+// The roots are taken when the index is created, on the thread that uses
+// the Hunspell object; build, load and save read only that list and the
+// words of its entries, which never change, so they may run on another
+// thread meanwhile. Dictionaries and words added later are not in the
+// index, SuggestMgr scores them one by one.
+class SuggestIndex {
+  int utf8;
+  const struct cs_info* csconv;
+  int langnum;
+  std::vector<struct hentry*> roots;  // walk_hashtable order, dictionary by dictionary
+  std::vector<size_t> added;          // get_added().size() of each dictionary
+  // postings grouped by bucket (low bits of the deletion hash), roots in
+  // order within a bucket; starts has one more element than there are
+  // buckets. A posting is the position of the root in roots (24 bits) under
+  // the high 8 bits of the hash, which tell most deletions of a bucket apart;
+  // the roots of the others are only scored for nothing.
+  std::vector<uint32_t> starts;
+  std::vector<uint32_t> postings;
+  std::vector<uint32_t> unindexed;  // roots with characters outside the BMP, always candidates
+  bool ready;
+  std::atomic<bool> cancelled;
+
+ public:
+  SuggestIndex(const std::vector<std::unique_ptr<HashMgr>>& rHMgr,
+               int utf8,
+               const struct cs_info* csconv,
+               int langnum);
+  SuggestIndex(const SuggestIndex&) = delete;
+  SuggestIndex& operator=(const SuggestIndex&) = delete;
+
+  // false if cancelled on the way
+  bool build();
+  // from any thread, a running build stops early
+  void cancel();
+  // index cache next to the dictionary; loading fails unless the file was
+  // saved by this build from the same roots
+  bool save(const char* path) const;
+  bool load(const char* path);
+  bool is_ready() const;
+  size_t get_root_count() const;
+  size_t get_memory_size() const;
+
+  // what the index covers: the first get_dic_count() dictionaries, with the
+  // first get_added_count(i) words added to dictionary i
+  size_t get_dic_count() const;
+  size_t get_added_count(size_t dic) const;
+
+  // indexed roots near word (in the dictionary encoding, reversed with
+  // COMPLEXPREFIXES as stored), in walk_hashtable order; false if the word
+  // has characters outside the BMP, the index has no keys for it
+  bool candidates(const char* word, std::vector<struct hentry*>& out) const;
+
+ private:
+  int make_key(const char* word, size_t len, size_t max, std::vector<uint16_t>& key) const;
+  uint64_t roots_digest() const;
+};
+
+#endif
@@ -1141,6 +1141,14 @@ int SuggestMgr::movechar_utf(std::vector<std::string>& wlst,
   return wlst.size();
 }
 
+void SuggestMgr::set_index(SuggestIndex* idx) {
+  index.reset(idx);
+}
+
+bool SuggestMgr::has_index() const {
+  return index && index->is_ready();
+}
+
 namespace
 {
   class ngsuggest_guard
@@ -1266,123 +1274,146 @@ void SuggestMgr::ngsuggest(std::vector<std::string>& wlst,
   std::string f;
   std::vector<w_char> w_f;
 
-  for (const auto& i : rHMgr) {
-    while (nullptr != (hp = i->walk_hashtable(col, hp))) {
-      // skip exceptions
-      if (
-           // skip it, if the word length different by 5 or
-           // more characters (to avoid strange suggestions)
-           // (except Unicode characters over BMP)
-           (((abs(n - hp->clen) > 4) && !nonbmp)) ||
-           // don't suggest capitalized dictionary words for
-           // lower case misspellings in ngram suggestions, except
-           // - PHONE usage, or
-           // - in the case of German, where not only proper
-           //   nouns are capitalized, or
-           // - the capitalized word has special pronunciation
-           ((captype == NOCAP) && (hp->var & H_OPT_INITCAP) &&
-              !ph && (langnum != LANG_de) && !(hp->var & H_OPT_PHON)) ||
-           // or it has one of the following special flags
-           ((hp->astr) && (pAMgr) &&
-             (TESTAFF(hp->astr, forbiddenword, hp->alen) ||
-             TESTAFF(hp->astr, ONLYUPCASEFLAG, hp->alen) ||
-             TESTAFF(hp->astr, nosuggest, hp->alen) ||
-             TESTAFF(hp->astr, nongramsuggest, hp->alen) ||
-             TESTAFF(hp->astr, onlyincompound, hp->alen)))
-         )
-        continue;
+  // scores a root, keeping it if it is among the MAX_ROOTS best so far
+  auto score_root = [&](struct hentry* hp) {
+    // skip exceptions
+    if (
+         // skip it, if the word length different by 5 or
+         // more characters (to avoid strange suggestions)
+         // (except Unicode characters over BMP)
+         (((abs(n - hp->clen) > 4) && !nonbmp)) ||
+         // don't suggest capitalized dictionary words for
+         // lower case misspellings in ngram suggestions, except
+         // - PHONE usage, or
+         // - in the case of German, where not only proper
+         //   nouns are capitalized, or
+         // - the capitalized word has special pronunciation
+         ((captype == NOCAP) && (hp->var & H_OPT_INITCAP) &&
+            !ph && (langnum != LANG_de) && !(hp->var & H_OPT_PHON)) ||
+         // or it has one of the following special flags
+         ((hp->astr) && (pAMgr) &&
+           (TESTAFF(hp->astr, forbiddenword, hp->alen) ||
+           TESTAFF(hp->astr, ONLYUPCASEFLAG, hp->alen) ||
+           TESTAFF(hp->astr, nosuggest, hp->alen) ||
+           TESTAFF(hp->astr, nongramsuggest, hp->alen) ||
+           TESTAFF(hp->astr, onlyincompound, hp->alen)))
+       )
+      return;
+
+    if (utf8) {
+      u8_u16(w_f, HENTRY_WORD(hp));
 
+      int leftcommon = leftcommonsubstring(w_word, w_f);
+      if (low) {
+        // lowering dictionary word
+        mkallsmall_utf(w_f, langnum);
+      }
+      sc = ngram(3, w_word, w_f, NGRAM_LONGER_WORSE) + leftcommon;
+    } else {
+      f.assign(HENTRY_WORD(hp));
+
+      int leftcommon = leftcommonsubstring(word, f.c_str());
+      if (low) {
+        // lowering dictionary word
+        mkallsmall(f, csconv);
+      }
+      sc = ngram(3, word, f, NGRAM_LONGER_WORSE) + leftcommon;
+    }
+
+    // check special pronunciation
+    f.clear();
+    if ((hp->var & H_OPT_PHON) &&
+        copy_field(f, HENTRY_DATA(hp), MORPH_PHON)) {
+      int sc2;
       if (utf8) {
-        u8_u16(w_f, HENTRY_WORD(hp));
+        u8_u16(w_f, f);
 
         int leftcommon = leftcommonsubstring(w_word, w_f);
         if (low) {
           // lowering dictionary word
           mkallsmall_utf(w_f, langnum);
         }
-        sc = ngram(3, w_word, w_f, NGRAM_LONGER_WORSE) + leftcommon;
+        sc2 = ngram(3, w_word, w_f, NGRAM_LONGER_WORSE) + leftcommon;
       } else {
-        f.assign(HENTRY_WORD(hp));
-
         int leftcommon = leftcommonsubstring(word, f.c_str());
         if (low) {
           // lowering dictionary word
           mkallsmall(f, csconv);
         }
-        sc = ngram(3, word, f, NGRAM_LONGER_WORSE) + leftcommon;
+        sc2 = ngram(3, word, f, NGRAM_LONGER_WORSE) + leftcommon;
       }
+      if (sc2 > sc)
+        sc = sc2;
+    }
 
-      // check special pronunciation
-      f.clear();
-      if ((hp->var & H_OPT_PHON) &&
-          copy_field(f, HENTRY_DATA(hp), MORPH_PHON)) {
-        int sc2;
-        if (utf8) {
-          u8_u16(w_f, f);
-
-          int leftcommon = leftcommonsubstring(w_word, w_f);
-          if (low) {
-            // lowering dictionary word
-            mkallsmall_utf(w_f, langnum);
-          }
-          sc2 = ngram(3, w_word, w_f, NGRAM_LONGER_WORSE) + leftcommon;
-        } else {
-          int leftcommon = leftcommonsubstring(word, f.c_str());
-          if (low) {
-            // lowering dictionary word
-            mkallsmall(f, csconv);
-          }
-          sc2 = ngram(3, word, f, NGRAM_LONGER_WORSE) + leftcommon;
-        }
-        if (sc2 > sc)
-          sc = sc2;
+    int scphon = -20000;
+    if (ph && (sc > 2) && (abs(n - (int)hp->clen) <= 3)) {
+      if (utf8) {
+        u8_u16(w_candidate, HENTRY_WORD(hp));
+        mkallcap_utf(w_candidate, langnum);
+        u16_u8(candidate, w_candidate);
+      } else {
+        candidate = HENTRY_WORD(hp);
+        mkallcap(candidate, csconv);
+      }
+      f = phonet(candidate, *ph);
+      if (utf8) {
+        u8_u16(w_f, f);
+        scphon = 2 * ngram(3, w_target, w_f,
+                           NGRAM_LONGER_WORSE);
+      } else {
+        scphon = 2 * ngram(3, target, f,
+                           NGRAM_LONGER_WORSE);
       }
+    }
 
-      int scphon = -20000;
-      if (ph && (sc > 2) && (abs(n - (int)hp->clen) <= 3)) {
-        if (utf8) {
-          u8_u16(w_candidate, HENTRY_WORD(hp));
-          mkallcap_utf(w_candidate, langnum);
-          u16_u8(candidate, w_candidate);
-        } else {
-          candidate = HENTRY_WORD(hp);
-          mkallcap(candidate, csconv);
+    if (sc > scores[lp]) {
+      scores[lp] = sc;
+      roots[lp] = hp;
+      has_roots = true;
+      lval = sc;
+      for (int j = 0; j < MAX_ROOTS; j++)
+        if (scores[j] < lval) {
+          lp = j;
+          lval = scores[j];
         }
-        f = phonet(candidate, *ph);
-        if (utf8) {
-          u8_u16(w_f, f);
-          scphon = 2 * ngram(3, w_target, w_f,
-                             NGRAM_LONGER_WORSE);
-        } else {
-          scphon = 2 * ngram(3, target, f,
-                             NGRAM_LONGER_WORSE);
-        }
-      }
+    }
 
-      if (sc > scores[lp]) {
-        scores[lp] = sc;
-        roots[lp] = hp;
-        has_roots = true;
-        lval = sc;
-        for (int j = 0; j < MAX_ROOTS; j++)
-          if (scores[j] < lval) {
-            lp = j;
-            lval = scores[j];
-          }
-      }
+    if (scphon > scoresphon[lpphon]) {
+      scoresphon[lpphon] = scphon;
+      rootsphon[lpphon] = HENTRY_WORD(hp);
+      has_rootsphon = true;
+      lval = scphon;
+      for (int j = 0; j < MAX_ROOTS; j++)
+        if (scoresphon[j] < lval) {
+          lpphon = j;
+          lval = scoresphon[j];
+        }
+    }
+  };
 
-      if (scphon > scoresphon[lpphon]) {
-        scoresphon[lpphon] = scphon;
-        rootsphon[lpphon] = HENTRY_WORD(hp);
-        has_rootsphon = true;
-        lval = scphon;
-        for (int j = 0; j < MAX_ROOTS; j++)
-          if (scoresphon[j] < lval) {
-            lpphon = j;
-            lval = scoresphon[j];
-          }
+  // the index, when there is one that can stand in for the scan: the
+  // phonetic scores need every root, and its keys are BMP characters
+  std::vector<struct hentry*> nearby;
+  if (index && !ph && !nonbmp && index->candidates(word, nearby)) {
+    for (struct hentry* root : nearby)
+      score_root(root);
+    // what the index doesn't cover: words and dictionaries added later
+    for (size_t i = 0; i < rHMgr.size(); ++i) {
+      if (i < index->get_dic_count()) {
+        const std::vector<struct hentry*>& added = rHMgr[i]->get_added();
+        for (size_t j = index->get_added_count(i); j < added.size(); ++j)
+          score_root(added[j]);
+      } else {
+        while (nullptr != (hp = rHMgr[i]->walk_hashtable(col, hp)))
+          score_root(hp);
       }
     }
+  } else {
+    for (const auto& i : rHMgr) {
+      while (nullptr != (hp = i->walk_hashtable(col, hp)))
+        score_root(hp);
+    }
   }
 
   if (!has_roots && !has_rootsphon) {
@@ -89,6 +89,7 @@
 #include "affixmgr.hxx"
 #include "hashmgr.hxx"
 #include "langnum.hxx"
+#include "suggestindex.hxx"
 
 enum { LCS_UP, LCS_LEFT, LCS_UPLEFT };
 
@@ -113,6 +114,8 @@ class SuggestMgr {
   int maxcpdsugs;
   int complexprefixes;
   std::chrono::steady_clock::time_point suggest_start;
+  // roots near a misspelling for ngsuggest, instead of the scan of all roots
+  std::unique_ptr<SuggestIndex> index;
 
  public:
   SuggestMgr(const std::string& tryme, unsigned int maxn, AffixMgr* aptr);
@@ -126,6 +129,9 @@ class SuggestMgr {
           // and it returns with true at the first suggestion found
           bool test_simplesug = false);
   void ngsuggest(std::vector<std::string>& slst, const char* word, const std::vector<std::unique_ptr<HashMgr>>& rHMgr, int captype);
+  // takes ownership, nullptr goes back to the scan
+  void set_index(SuggestIndex* idx);
+  bool has_index() const;
 
   std::string suggest_morph(const std::string& word);
   std::string suggest_gen(const std::vector<std::string>& pl, const std::string& pattern,